@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <type_traits>
+#include "../6/trace.h"
 
 namespace cpplab
 {
@@ -98,6 +99,7 @@ namespace cpplab
     template <typename T>
     void vector<T>::realloc(size_t newcap)
     {
+        TRACE_SPAN_ARG("vector::realloc", "capacity", newcap);
         if (newcap < Size)
             newcap = Size;
 
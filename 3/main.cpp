@@ -30,5 +30,7 @@ int main(){
 
     std::cout<< v * w<< "\t" << w * v << "\t"<< v*vv <<"\n";
 
+    TRACE_EXPORT("trace.json");
+
 
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <vector>
 #include <type_traits>
 #include <concepts>
+#include "../6/trace.h"
 
 namespace cpplab
 {
@@ -111,6 +112,7 @@ namespace cpplab
     template <typename T>
     void vector<T>::realloc(size_t newcap)
     {
+        TRACE_SPAN_ARG("vector::realloc", "capacity", newcap);
         if (newcap < Size)
             newcap = Size;
 
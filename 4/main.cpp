@@ -19,4 +19,6 @@ int main()
 
     std::cout<< "\n" << vi * ui << 
     "\n" << vd * ud << "\n" <<  vd * ui << "\n\n";
+
+    TRACE_EXPORT("trace.json");
 }
\ No newline at end of file
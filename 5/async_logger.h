@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
+
+// Asynchroniczny logger. Każdy wątek piszący ma własny bufor cykliczny
+// SPSC z rekordami stałej wielkości; wątek tła zbiera rekordy ze wszystkich
+// buforów, formatuje je partiami i wypisuje jednym wywołaniem write().
+class Async_logger
+{
+public:
+    // Co zrobić, gdy bufor wątku jest pełny
+    enum class Overflow
+    {
+        drop,
+        block
+    };
+
+    static constexpr std::size_t maxMessage = 200;
+
+private:
+    struct Record
+    {
+        std::uint64_t timeNs;
+        std::uint32_t length;
+        char text[maxMessage];
+    };
+
+    // Bufor jednego wątku: pisze tylko właściciel, czyta tylko wątek tła
+    struct Ring
+    {
+        explicit Ring(std::size_t capacity)
+            : records(capacity), mask(capacity - 1) {}
+
+        // prefiks z identyfikatorem wątku liczony raz, przy przydziale bufora
+        void assign(pthread_t thread)
+        {
+            prefixLength = std::snprintf(prefix, sizeof(prefix), "Thread: %lu:\t", (unsigned long)thread);
+        }
+
+        std::vector<Record> records;
+        std::size_t mask;
+        char prefix[48];
+        int prefixLength{0};
+        // ustawiane, gdy właściciel kończy działanie - po opróżnieniu bufor
+        // wraca do puli zapasowych
+        std::atomic<bool> retired{false};
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+    };
+
+    // Bufor wątku trzymany w thread_local; shared_ptr, bo wątek może się
+    // skończyć po zniszczeniu loggera
+    struct Ring_holder
+    {
+        std::uint64_t owner{0};
+        std::shared_ptr<Ring> ring;
+
+        void release()
+        {
+            if (ring)
+                ring->retired.store(true, std::memory_order_release);
+            ring.reset();
+            owner = 0;
+        }
+
+        ~Ring_holder()
+        {
+            release();
+        }
+    };
+
+    static constexpr std::size_t maxSpareRings = 16;
+
+    static inline std::atomic<std::uint64_t> nextId{1};
+
+    std::uint64_t id{nextId.fetch_add(1)};
+    int fd;
+    Overflow overflow;
+    std::size_t ringCapacity;
+
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::vector<std::shared_ptr<Ring>> spareRings;
+    std::atomic<std::uint64_t> dropped{0};
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    // wątek tła czeka na wake - piszący muszą go obudzić
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+    std::string batch;
+    std::vector<Ring *> snapshot;
+    std::vector<std::size_t> heads;
+    std::vector<Ring *> finished;
+
+    struct Pending
+    {
+        const Ring *ring;
+        const Record *record;
+    };
+    std::vector<Pending> pending;
+
+    Ring &local_ring()
+    {
+        // wątek zapamiętuje swój bufor (i identyfikator loggera) przy pierwszym użyciu
+        thread_local Ring_holder holder;
+        if (holder.owner != id)
+        {
+            holder.release();
+            holder.ring = adopt_ring();
+            holder.owner = id;
+        }
+        return *holder.ring;
+    }
+
+    // Bufor po zakończonym wątku, jeśli jest, a inaczej nowy
+    std::shared_ptr<Ring> adopt_ring()
+    {
+        std::shared_ptr<Ring> ring;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            if (!spareRings.empty())
+            {
+                ring = std::move(spareRings.back());
+                spareRings.pop_back();
+            }
+        }
+        if (!ring)
+            ring = std::make_shared<Ring>(ringCapacity);
+        ring->assign(pthread_self());
+        ring->retired.store(false, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    // Wołane przez wątek tła dla opróżnionych buforów zakończonych wątków
+    void recycle(const std::vector<Ring *> &done)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (Ring *ring : done)
+        {
+            auto it = std::find_if(rings.begin(), rings.end(),
+                                   [ring](const std::shared_ptr<Ring> &r) { return r.get() == ring; });
+            if (spareRings.size() < maxSpareRings)
+                spareRings.push_back(std::move(*it));
+            rings.erase(it);
+        }
+    }
+
+    static std::uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void format(const Ring &ring, const Record &r)
+    {
+        batch.append(ring.prefix, ring.prefixLength);
+        batch.append(r.text, r.length);
+        batch.push_back('\n');
+    }
+
+    // Zbiera wszystko, co jest w buforach; zwraca liczbę rekordów
+    std::size_t drain()
+    {
+        std::size_t count = 0;
+        snapshot.clear();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto &r : rings)
+                snapshot.push_back(r.get());
+        }
+
+        heads.clear();
+        pending.clear();
+        finished.clear();
+        for (Ring *ring : snapshot)
+        {
+            // najpierw retired, potem head: zakończony wątek nic już nie dopisze
+            if (ring->retired.load(std::memory_order_acquire))
+                finished.push_back(ring);
+            std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+            std::size_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail)
+                pending.push_back({ring, &ring->records[tail & ring->mask]});
+            heads.push_back(head);
+        }
+
+        // w obrębie partii rekordy różnych wątków układamy według czasu zapisu
+        std::sort(pending.begin(), pending.end(), [](const Pending &a, const Pending &b)
+                  { return a.record->timeNs < b.record->timeNs; });
+        for (const Pending &p : pending)
+            format(*p.ring, *p.record);
+        count = pending.size();
+
+        if (!batch.empty())
+        {
+            const char *p = batch.data();
+            std::size_t left = batch.size();
+            while (left > 0)
+            {
+                ssize_t written = ::write(fd, p, left);
+                if (written <= 0)
+                    break;
+                p += written;
+                left -= std::size_t(written);
+            }
+            batch.clear();
+        }
+
+        // miejsce w buforach zwalniamy dopiero po zapisie, dzięki temu flush()
+        // wie, że rekordy są już w pliku
+        for (std::size_t i = 0; i < snapshot.size(); ++i)
+            snapshot[i]->tail.store(heads[i], std::memory_order_release);
+        if (!finished.empty())
+            recycle(finished);
+        return count;
+    }
+
+    bool has_records()
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (auto &r : rings)
+            if (r->head.load(std::memory_order_acquire) != r->tail.load(std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+
+    void wake_writer()
+    {
+        if (sleeping.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wake.notify_one();
+        }
+    }
+
+    void run()
+    {
+        while (!stopping.load(std::memory_order_acquire))
+        {
+            if (drain() == 0)
+            {
+                // sleeping ustawiamy przed ostatnim sprawdzeniem buforów, więc
+                // rekord dopisany w międzyczasie albo zobaczymy, albo piszący
+                // nas obudzi; timeout to tylko zabezpieczenie
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                sleeping.store(true, std::memory_order_seq_cst);
+                if (!has_records() && !stopping.load(std::memory_order_acquire))
+                    wake.wait_for(lock, std::chrono::milliseconds(1));
+                sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+        drain();
+    }
+
+public:
+    // ringCapacity musi być potęgą dwójki
+    explicit Async_logger(int fd = STDOUT_FILENO, Overflow overflow = Overflow::block,
+                          std::size_t ringCapacity = 1024)
+        : fd(fd), overflow(overflow), ringCapacity(ringCapacity)
+    {
+        batch.reserve(ringCapacity * 64);
+        writer = std::thread(&Async_logger::run, this);
+    }
+
+    ~Async_logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping.store(true, std::memory_order_release);
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    Async_logger(const Async_logger &) = delete;
+    Async_logger &operator=(const Async_logger &) = delete;
+
+    // Zapis rekordu: kopiowanie do bufora wątku, bez blokad i bez I/O.
+    // Dłuższe wiadomości są obcinane do maxMessage znaków.
+    void log(std::string_view message)
+    {
+        Ring &ring = local_ring();
+        std::size_t head = ring.head.load(std::memory_order_relaxed);
+        std::size_t tail = ring.tail.load(std::memory_order_acquire);
+
+        while (head - tail > ring.mask)
+        {
+            if (overflow == Overflow::drop)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wake_writer();
+            std::this_thread::yield();
+            tail = ring.tail.load(std::memory_order_acquire);
+        }
+
+        Record &r = ring.records[head & ring.mask];
+        r.timeNs = now_ns();
+        r.length = std::uint32_t(std::min(message.size(), maxMessage));
+        std::memcpy(r.text, message.data(), r.length);
+        ring.head.store(head + 1, std::memory_order_release);
+        // budzimy wątek tła dopiero przy zapełnieniu ćwierci bufora, żeby
+        // zapisywał partiami; pojedyncze wpisy odbierze po najwyżej 1 ms
+        if (head + 1 - tail == (ring.mask + 1) / 4)
+            wake_writer();
+    }
+
+    // Czeka, aż wszystko, co wątek zalogował przed wywołaniem, trafi do pliku
+    void flush()
+    {
+        Ring &ring = local_ring();
+        std::size_t head = ring.head.load(std::memory_order_relaxed);
+        while (ring.tail.load(std::memory_order_acquire) != head)
+        {
+            wake_writer();
+            std::this_thread::yield();
+        }
+    }
+
+    std::uint64_t dropped_count() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,191 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <algorithm>
+#include <future>
+#include <random>
+
+#include <fcntl.h>
+#include <time.h>
+#include "async_logger.h"
+#include "fork_join.h"
+
+// Koszt jednego wpisu: czas CPU wątku piszącego na wywołanie (to, co płaci
+// wołający) i czas rzeczywisty całego przebiegu na wpis (razem z pracą wątku
+// tła). Wiadomość budowana jest raz, żeby mierzyć samo logowanie, a nie
+// składanie napisów.
+struct Log_cost
+{
+    double callerNs;
+    double wallNs;
+};
+
+static double thread_cpu_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+template <typename Log>
+Log_cost ns_per_call(int threads, int perThread, Log log)
+{
+    std::vector<std::thread> workers;
+    std::vector<double> perCall(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::string message = "worker " + std::to_string(t) + " message";
+            double cpuStart = thread_cpu_ns();
+            for (int i = 0; i < perThread; ++i)
+                log(message);
+            perCall[t] = (thread_cpu_ns() - cpuStart) / perThread;
+        });
+    for (auto &w : workers)
+        w.join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double sum = 0;
+    for (double ns : perCall)
+        sum += ns;
+    return {sum / threads, double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / (double(threads) * perThread)};
+}
+
+static long fib_async(int n, std::launch policy)
+{
+    if (n < 2)
+        return n;
+    auto left = std::async(policy, fib_async, n - 1, policy);
+    long right = fib_async(n - 2, policy);
+    return left.get() + right;
+}
+
+static long fib_seq(int n)
+{
+    return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+static long fib_fork_join(int n, Fork_join_pool &pool)
+{
+    if (n < 20)
+        return fib_seq(n);
+    long left = 0, right = 0;
+    pool.invoke_parallel([&] { left = fib_fork_join(n - 1, pool); },
+                         [&] { right = fib_fork_join(n - 2, pool); });
+    return left + right;
+}
+
+template <typename Fork>
+static void quicksort(int *first, int *last, Fork fork)
+{
+    if (last - first < 10000)
+    {
+        std::sort(first, last);
+        return;
+    }
+    int pivot = first[(last - first) / 2];
+    int *middle1 = std::partition(first, last, [pivot](int x) { return x < pivot; });
+    int *middle2 = std::partition(middle1, last, [pivot](int x) { return !(pivot < x); });
+    fork([=] { quicksort(first, middle1, fork); }, [=] { quicksort(middle2, last, fork); });
+}
+
+template <typename F>
+static double ms(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void fork_join_bench()
+{
+    Fork_join_pool pool;
+
+    // std::async(launch::async) tworzy wątek na każde wywołanie, więc n musi być małe
+    const int small = 16, big = 32;
+    long r1 = 0, r2 = 0, r3 = 0, r4 = 0;
+    std::cout << "fib(" << small << ") launch::async:   " << ms([&] { r1 = fib_async(small, std::launch::async); }) << " ms\n"
+              << "fib(" << small << ") launch::deferred: " << ms([&] { r2 = fib_async(small, std::launch::deferred); }) << " ms\n"
+              << "fib(" << big << ") sequential:      " << ms([&] { r3 = fib_seq(big); }) << " ms\n"
+              << "fib(" << big << ") Fork_join_pool:  " << ms([&] { r4 = fib_fork_join(big, pool); }) << " ms\n";
+    if (r1 != r2 || r3 != r4)
+        std::cout << "fib mismatch!\n";
+
+    std::vector<int> data(4000000);
+    std::mt19937 rng(42);
+    for (int &x : data)
+        x = int(rng());
+    auto a = data, b = data, c = data;
+
+    auto with_async = [](std::launch policy) {
+        return [policy](auto f, auto g) {
+            auto child = std::async(policy, g);
+            f();
+            child.get();
+        };
+    };
+    auto with_pool = [&pool](auto f, auto g) { pool.invoke_parallel(f, g); };
+
+    std::cout << "quicksort 4M launch::async:   " << ms([&] { quicksort(a.data(), a.data() + a.size(), with_async(std::launch::async)); }) << " ms\n"
+              << "quicksort 4M launch::deferred: " << ms([&] { quicksort(b.data(), b.data() + b.size(), with_async(std::launch::deferred)); }) << " ms\n"
+              << "quicksort 4M Fork_join_pool:  " << ms([&] { quicksort(c.data(), c.data() + c.size(), with_pool); }) << " ms\n";
+    if (!std::is_sorted(a.begin(), a.end()) || a != b || b != c)
+        std::cout << "sort mismatch!\n";
+}
+
+int main()
+{
+    const int threads = 4, perThread = 200000;
+    std::cout << "threads: " << threads << ", messages per thread: " << perThread
+              << ", cores: " << std::thread::hardware_concurrency() << '\n';
+
+    // dawna ścieżka my_print (z poprawionym mutexem) do /dev/null
+    std::ofstream devnull("/dev/null");
+    std::mutex mtx;
+    Log_cost iostream = ns_per_call(threads, perThread, [&](std::string_view str) {
+        std::lock_guard<std::mutex> lock(mtx);
+        devnull << "Thread: " << pthread_self() << ":\t" << str << '\n';
+    });
+
+    int fd = open("/dev/null", O_WRONLY);
+    Log_cost blocking, accepted, dropping;
+    std::uint64_t droppedAccepted, dropped;
+    {
+        Async_logger logger(fd, Async_logger::Overflow::block);
+        blocking = ns_per_call(threads, perThread, [&](std::string_view str) { logger.log(str); });
+    }
+    {
+        // bufor mieści wszystkie wpisy - mierzymy sam zapis do bufora. Pierwszy
+        // przebieg płaci za strony nowych buforów; drugi dostaje bufory po
+        // zakończonych wątkach pierwszego
+        Async_logger logger(fd, Async_logger::Overflow::drop, 1 << 16);
+        ns_per_call(threads, 1 << 15, [&](std::string_view str) { logger.log(str); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        accepted = ns_per_call(threads, 1 << 15, [&](std::string_view str) { logger.log(str); });
+        droppedAccepted = logger.dropped_count();
+    }
+    {
+        Async_logger logger(fd, Async_logger::Overflow::drop);
+        dropping = ns_per_call(threads, perThread, [&](std::string_view str) { logger.log(str); });
+        dropped = logger.dropped_count();
+    }
+    close(fd);
+
+    auto row = [](const char *name, Log_cost c) {
+        std::cout << name << c.callerNs << "\t     " << c.wallNs << '\n';
+    };
+    std::cout << "                               caller CPU ns/call  wall ns/record\n";
+    row("iostream + mutex:              ", iostream);
+    row("Async_logger (block):          ", blocking);
+    row("Async_logger (no overflow):    ", accepted);
+    std::cout << "    dropped " << droppedAccepted << '\n';
+    row("Async_logger (drop, 1k ring):  ", dropping);
+    std::cout << "    dropped " << dropped << " of " << threads * perThread << '\n';
+
+    fork_join_bench();
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Pula fork-join o stałej liczbie wątków. spawn() odkłada zadanie potomne
+// do kolejki, sync() czeka na nie, a w międzyczasie wątek czekający pomaga
+// wykonywać inne zadania. Przy nasyconej puli lub po przekroczeniu
+// maksymalnej głębokości zadanie potomne wykonuje się w miejscu, więc
+// rekurencja nie tworzy nowych wątków.
+class Fork_join_pool
+{
+private:
+    enum State
+    {
+        queued,
+        deferred,
+        running,
+        done
+    };
+
+    struct Job
+    {
+        void (*invoke)(void *);
+        void *context;
+        std::atomic<int> state{queued};
+        int depth{0};
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job *> jobs;
+    std::size_t idle{0};
+    std::size_t maxDepth;
+    bool stopping{false};
+
+    static int &current_depth()
+    {
+        thread_local int depth = 0;
+        return depth;
+    }
+
+    void execute(Job *job)
+    {
+        int &depth = current_depth();
+        int saved = depth;
+        depth = job->depth;
+        try
+        {
+            job->invoke(job->context);
+        }
+        catch (...)
+        {
+            job->error = std::current_exception();
+        }
+        depth = saved;
+
+        // pod mutexem: wątek w wait() nie zobaczy `done` (i nie zniszczy
+        // zadania) przed końcem notify_all
+        std::lock_guard<std::mutex> lock{mutex};
+        job->state.store(done, std::memory_order_release);
+        job->state.notify_all();
+    }
+
+    void worker_loop()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true)
+        {
+            idle++;
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            idle--;
+            if (jobs.empty())
+                return;
+
+            // najstarsze zadanie - zwykle największy podproblem
+            Job *job = jobs.front();
+            jobs.pop_front();
+            job->state.store(running, std::memory_order_relaxed);
+            lock.unlock();
+            execute(job);
+            lock.lock();
+        }
+    }
+
+    void push(Job *job)
+    {
+        job->depth = current_depth() + 1;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            bool saturated = idle == 0 && jobs.size() >= workers.size();
+            if (workers.empty() || saturated || job->depth > int(maxDepth))
+            {
+                job->state.store(deferred, std::memory_order_relaxed);
+                return;
+            }
+            jobs.push_back(job);
+        }
+        cv.notify_one();
+    }
+
+    void wait(Job *job)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        int state = job->state.load(std::memory_order_relaxed);
+        if (state == queued)
+        {
+            // nikt go jeszcze nie wziął - wykonujemy sami
+            jobs.erase(std::find(jobs.rbegin(), jobs.rend(), job).base() - 1);
+            state = deferred;
+        }
+        if (state == deferred)
+        {
+            job->state.store(running, std::memory_order_relaxed);
+            lock.unlock();
+            execute(job);
+            return;
+        }
+
+        // zadanie wykonuje inny wątek - do tego czasu pomagamy
+        while (job->state.load(std::memory_order_acquire) != done)
+        {
+            if (!jobs.empty())
+            {
+                Job *other = jobs.back();
+                jobs.pop_back();
+                other->state.store(running, std::memory_order_relaxed);
+                lock.unlock();
+                execute(other);
+                lock.lock();
+            }
+            else
+            {
+                lock.unlock();
+                job->state.wait(running, std::memory_order_acquire);
+                lock.lock();
+            }
+        }
+    }
+
+public:
+    // Zadanie potomne; uchwytu nie można przenosić, bo kolejka trzyma jego adres
+    template <typename F>
+    class Spawned
+    {
+    private:
+        Job job;
+        F f;
+        Fork_join_pool &pool;
+        bool synced{false};
+
+        static void call(void *self)
+        {
+            static_cast<Spawned *>(self)->f();
+        }
+
+    public:
+        Spawned(Fork_join_pool &pool, F f) : f(std::move(f)), pool(pool)
+        {
+            job.invoke = &Spawned::call;
+            job.context = this;
+            pool.push(&job);
+        }
+
+        Spawned(const Spawned &) = delete;
+        Spawned &operator=(const Spawned &) = delete;
+
+        ~Spawned()
+        {
+            if (!synced)
+                pool.wait(&job);
+        }
+
+        void sync()
+        {
+            synced = true;
+            pool.wait(&job);
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+    };
+
+    explicit Fork_join_pool(std::size_t numThreads = std::max(1u, std::thread::hardware_concurrency()),
+                            std::size_t maxDepth = 16)
+        : maxDepth(maxDepth)
+    {
+        for (std::size_t i = 0; i < numThreads; ++i)
+            workers.emplace_back([this] { worker_loop(); });
+    }
+
+    ~Fork_join_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto &w : workers)
+            w.join();
+    }
+
+    template <typename F>
+    Spawned<std::decay_t<F>> spawn(F &&f)
+    {
+        return Spawned<std::decay_t<F>>(*this, std::forward<F>(f));
+    }
+
+    // Wykonuje f i g, potencjalnie równolegle; wraca, gdy oba się zakończą
+    template <typename F, typename G>
+    void invoke_parallel(F &&f, G &&g)
+    {
+        auto child = spawn(std::forward<G>(g));
+        f();
+        child.sync();
+    }
+};
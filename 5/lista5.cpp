@@ -3,19 +3,24 @@
 #include <mutex>
 #include <thread>
 #include <future>
+#include "async_logger.h"
+#include "fork_join.h"
+#include "../6/trace.h"
 
-pthread_t my_id() 
+Async_logger &logger()
 {
-    return pthread_self();
+    static Async_logger instance;
+    return instance;
 }
 
+// Identyfikator wątku dopisuje wątek loggera, z prefiksu zapamiętanego dla bufora
 void my_print(std::string str)
 {
-    std::lock_guard<std::mutex> lock(std::mutex mtx);
-    std::cout << "Thread: " << my_id() << ":\t" << str << '\n';
+    logger().log(str);
 }
 
 void asyncFunction(int depth, std::launch policy) {
+    TRACE_SPAN_ARG("asyncFunction", "depth", depth);
     my_print("Start asyncFunction, Depth: " + std::to_string(depth));
 
     if (depth > 0) {
@@ -26,12 +31,35 @@ void asyncFunction(int depth, std::launch policy) {
     my_print("End async Function, Depth: " + std::to_string(depth));
 }
 
+// Ta sama rekurencja na puli fork-join: zamiast nowego wątku na poziom
+// zadanie potomne trafia do ograniczonej puli albo wykonuje się w miejscu
+void forkJoinFunction(int depth, Fork_join_pool &pool) {
+    TRACE_SPAN_ARG("forkJoinFunction", "depth", depth);
+    my_print("Start forkJoinFunction, Depth: " + std::to_string(depth));
+
+    if (depth > 0) {
+        auto child = pool.spawn([depth, &pool] { forkJoinFunction(depth - 1, pool); });
+        child.sync();
+    }
+
+    my_print("End forkJoinFunction, Depth: " + std::to_string(depth));
+}
+
 int main() {
     my_print("Calling asyncFunction with std::launch::async policy: ");
     asyncFunction(3, std::launch::async);
-    std::cout<<'\n';
+    logger().flush();
+    std::cout<<'\n'<<std::flush;
     my_print("Calling asyncFunction with std::launch::deferred policy: ");
     asyncFunction(3, std::launch::deferred);
+    logger().flush();
+    std::cout<<'\n'<<std::flush;
+    my_print("Calling forkJoinFunction on Fork_join_pool: ");
+    Fork_join_pool pool{2};
+    forkJoinFunction(3, pool);
+    logger().flush();
+
+    TRACE_EXPORT("trace.json");
 
     return 0;
 }
\ No newline at end of file
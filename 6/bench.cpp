@@ -0,0 +1,306 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <fstream>
+#include <string>
+#include "thread_pool.cpp"
+#include "timer_wheel.h"
+#include "trace.h"
+
+// Licznik alokacji - podmieniamy globalny operator new/delete
+static std::atomic<std::size_t> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Dawna ścieżka add_task: std::function + shared_ptr<packaged_task>
+static std::size_t legacy_path(int n)
+{
+    std::size_t before = allocations.load();
+    double total = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        std::function<double()> task = [i, a = 1.0, b = 2.0]() -> double { return i * a + b; };
+        auto wrapper = std::make_shared<std::packaged_task<double()>>(std::move(task));
+        std::function<void()> queued = [=] { (*wrapper)(); };
+        auto future = wrapper->get_future();
+        queued();
+        total += future.get();
+    }
+    return allocations.load() - before;
+}
+
+static void spin_for(std::chrono::microseconds d)
+{
+    auto end = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < end)
+        ;
+}
+
+// Opóźnienie startu zadań pilnych przy kolejce zapchanej pracą wsadową
+static void priority_latency(Thread_pool::Priority urgent, const char *label)
+{
+    using namespace std::chrono;
+    // domyślny krok starzenia (100 ms); zaległość trwa wiele kroków, więc
+    // pomiar obejmuje też zadania wsadowe postarzałe do poziomu high
+    const int bulk = 100000, probes = 200;
+
+    Thread_pool pool{4};
+    std::vector<Task_future<void>> futures;
+    for (int i = 0; i < bulk; ++i)
+        futures.push_back(pool.submit([] { spin_for(microseconds(20)); }, Thread_pool::Priority::low));
+
+    std::vector<long> latency(probes);
+    for (int i = 0; i < probes; ++i)
+    {
+        auto submitted = steady_clock::now();
+        futures.push_back(pool.submit([&latency, i, submitted] {
+            latency[i] = duration_cast<microseconds>(steady_clock::now() - submitted).count();
+        }, urgent));
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    for (auto &f : futures)
+        f.get();
+
+    std::sort(latency.begin(), latency.end());
+    std::cout << label << " start latency us: p50 " << latency[probes / 2]
+              << " p99 " << latency[probes * 99 / 100] << " max " << latency.back() << '\n';
+}
+
+static int thread_count()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.rfind("Threads:", 0) == 0)
+            return std::stoi(line.substr(8));
+    return -1;
+}
+
+// Opóźnienie odpalenia i przepustowość koła czasowego przy 100k timerów
+static void timer_jitter()
+{
+    using namespace std::chrono;
+    const int timers = 100000;
+
+    Thread_pool pool{4};
+    Timer_wheel wheel{pool};
+    std::vector<long> jitter(timers);
+    std::atomic<int> fired{0};
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < timers; ++i)
+    {
+        auto delay = milliseconds(i % 1000);
+        auto target = start + delay;
+        wheel.schedule_after(delay, [&jitter, &fired, i, target] {
+            jitter[i] = duration_cast<microseconds>(steady_clock::now() - target).count();
+            fired.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    auto scheduled = steady_clock::now();
+    int threads = thread_count();
+    while (fired.load() < timers)
+        std::this_thread::sleep_for(milliseconds(10));
+
+    std::sort(jitter.begin(), jitter.end());
+    std::cout << "timers: " << timers << " in " << threads << " threads, schedule "
+              << duration_cast<nanoseconds>(scheduled - start).count() / timers << " ns per timer\n"
+              << "fire jitter us: p50 " << jitter[timers / 2] << " p99 " << jitter[timers * 99 / 100]
+              << " max " << jitter.back() << '\n';
+
+    // 100k timerów cyklicznych co 100 ms przez sekundę
+    std::atomic<long> ticks{0};
+    std::vector<Timer_wheel::Timer_id> ids;
+    for (int i = 0; i < timers; ++i)
+        ids.push_back(wheel.schedule_every(milliseconds(100), [&ticks] {
+            ticks.fetch_add(1, std::memory_order_relaxed);
+        }));
+    std::this_thread::sleep_for(seconds(1));
+    for (auto id : ids)
+        wheel.cancel(id);
+    std::cout << "periodic: " << ticks.load() << " firings/s (ideal " << timers * 10 << ")\n";
+}
+
+// Pula elastyczna (1..4 wątki): zadanie za długim zadaniem, zadanie
+// zagnieżdżone, wzrost przy zaległościach i kurczenie po idleTimeout
+static void elastic_pool()
+{
+    using namespace std::chrono;
+    Thread_pool pool{1, 4, milliseconds(200)};
+    int threadsBefore = thread_count();
+
+    auto blocker = pool.submit([] { std::this_thread::sleep_for(seconds(1)); });
+    std::this_thread::sleep_for(milliseconds(20));
+    auto start = steady_clock::now();
+    pool.submit([] {}).get();
+    auto behindLong = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    int nested = pool.submit([&pool] { return pool.submit([] { return 42; }).get(); }).get();
+    auto nestedUs = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    std::vector<Task_future<void>> burst;
+    for (int i = 0; i < 12; ++i)
+        burst.push_back(pool.submit([] { std::this_thread::sleep_for(milliseconds(50)); }));
+    start = steady_clock::now();
+    for (auto &f : burst)
+        f.get();
+    auto burstMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::size_t grown = pool.metrics().liveWorkers;
+    int threadsGrown = thread_count();
+
+    blocker.get();
+    std::this_thread::sleep_for(milliseconds(500));
+
+    std::cout << "\nelastic pool 1..4: task behind a 1 s task waited " << behindLong << " us"
+              << ", nested submit+get (" << nested << ") " << nestedUs << " us\n"
+              << "12 x 50 ms burst: " << burstMs << " ms, workers " << grown
+              << ", process threads " << threadsBefore << " -> " << threadsGrown
+              << " -> " << thread_count() << " after idle timeout (live " << pool.metrics().liveWorkers << ")\n";
+}
+
+// Przypinanie wątków: ile procesorów odwiedził każdy wątek puli
+static void affinity_modes()
+{
+    const std::size_t workers = std::min<std::size_t>(4, std::max<std::size_t>(1, allowed_cpus().size()));
+    const std::pair<Thread_pool::Affinity, const char *> modes[] = {
+        {Thread_pool::Affinity::none, "none"},
+        {Thread_pool::Affinity::cores, "cores"},
+        {Thread_pool::Affinity::numa, "numa"}};
+
+    std::cout << "\naffinity (" << allowed_cpus().size() << " cpus, " << numa_nodes().size()
+              << " numa nodes, " << workers << " workers):\n";
+    for (auto [affinity, label] : modes)
+    {
+        Thread_pool pool{workers, workers, std::chrono::seconds(30), affinity};
+        std::mutex seenMutex;
+        std::vector<std::pair<std::thread::id, int>> seen;
+        std::vector<Task_future<void>> futures;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 2000; ++i)
+            futures.push_back(pool.submit([&] {
+                spin_for(std::chrono::microseconds(100));
+                std::lock_guard<std::mutex> lock{seenMutex};
+                seen.push_back({std::this_thread::get_id(), sched_getcpu()});
+            }));
+        for (auto &f : futures)
+            f.get();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::sort(seen.begin(), seen.end());
+        seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+        std::vector<int> cpus;
+        std::size_t threads = 0, migrated = 0;
+        for (std::size_t i = 0; i < seen.size(); ++i)
+        {
+            cpus.push_back(seen[i].second);
+            if (i == 0 || seen[i].first != seen[i - 1].first)
+                threads++;
+            else if (i + 1 == seen.size() || seen[i + 1].first != seen[i].first)
+                migrated++;
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+        std::cout << "  Affinity::" << label << ": " << ms << " ms, " << cpus.size() << " cpus used, "
+                  << migrated << " of " << threads << " workers ran on more than one cpu\n";
+    }
+}
+
+// Koszt jednego TRACE_SPAN: ta sama pętla z zakresem i bez
+static void trace_overhead()
+{
+    const int n = 1000000;
+    volatile int sink = 0;
+    auto ns_per_iter = [n](auto body) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i)
+            body(i);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    };
+
+    double base = ns_per_iter([&](int i) { sink = i; });
+    double span = ns_per_iter([&](int i) {
+        TRACE_SPAN("bench span");
+        sink = i;
+    });
+    double counter = ns_per_iter([&](int i) {
+        TRACE_COUNTER("bench counter", i);
+        sink = i;
+    });
+
+#ifdef CPPLAB_TRACE
+    std::cout << "\ntracing enabled:";
+#else
+    std::cout << "\ntracing disabled (-DCPPLAB_TRACE to enable):";
+#endif
+    std::cout << " TRACE_SPAN " << span - base << " ns, TRACE_COUNTER " << counter - base << " ns per event\n";
+}
+
+int main()
+{
+    const int n = 100000;
+
+    std::size_t legacy = legacy_path(n);
+
+    Thread_pool pool{4};
+    // rozgrzewka - wypełnia pulę stanów i bufor kolejki
+    {
+        std::vector<Task_future<double>> warmup;
+        for (int i = 0; i < 1000; ++i)
+            warmup.push_back(pool.submit([i] { return double(i); }));
+        for (auto &f : warmup)
+            f.get();
+    }
+
+    std::size_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    double total = 0;
+    for (int i = 0; i < n; ++i)
+        total += pool.submit([i, a = 1.0, b = 2.0] { return i * a + b; }).get();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t pooled = allocations.load() - before;
+
+    std::cout << "tasks: " << n << '\n'
+              << "std::function + packaged_task allocations: " << legacy
+              << " (" << double(legacy) / n << " per task)\n"
+              << "Thread_pool::submit allocations: " << pooled
+              << " (" << double(pooled) / n << " per task)\n"
+              << "submit + get: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / n
+              << " ns per task\n"
+              << "checksum: " << total << '\n';
+
+    write_json(std::cout, pool.metrics());
+
+    priority_latency(Thread_pool::Priority::low, "same lane as bulk (FIFO):");
+    priority_latency(Thread_pool::Priority::high, "Priority::high:");
+
+    timer_jitter();
+
+    elastic_pool();
+    affinity_modes();
+
+    trace_overhead();
+
+#ifdef CPPLAB_TRACE
+    // bufory śledzenia alokują nowy kawałek co kilka tysięcy zdarzeń
+    return 0;
+#else
+    return pooled == 0 ? 0 : 1;
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Pomocnicze funkcje do przypinania wątków do rdzeni (tylko Linux;
+// na innych systemach zwracają puste listy i niczego nie robią).
+
+// Procesory, na których proces może się wykonywać
+inline std::vector<int> allowed_cpus()
+{
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+#endif
+    return cpus;
+}
+
+// Parsuje listę w formacie sysfs, np. "0-3,8-11"
+inline std::vector<int> parse_cpu_list(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        if (range.empty())
+            continue;
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// Procesory pogrupowane według węzłów NUMA z /sys/devices/system/node.
+// Bez informacji o NUMA zwraca jeden węzeł ze wszystkimi dozwolonymi procesorami.
+inline std::vector<std::vector<int>> numa_nodes()
+{
+    std::vector<std::vector<int>> nodes;
+    std::vector<int> allowed = allowed_cpus();
+
+    for (int node = 0;; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file)
+            break;
+        std::string list;
+        std::getline(file, list);
+
+        std::vector<int> cpus;
+        for (int cpu : parse_cpu_list(list))
+            for (int a : allowed)
+                if (a == cpu)
+                    cpus.push_back(cpu);
+        if (!cpus.empty())
+            nodes.push_back(std::move(cpus));
+    }
+
+    if (nodes.empty() && !allowed.empty())
+        nodes.push_back(allowed);
+    return nodes;
+}
+
+// Ogranicza bieżący wątek do podanych procesorów
+inline bool pin_current_thread(const std::vector<int> &cpus)
+{
+#ifdef __linux__
+    if (cpus.empty())
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+        CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
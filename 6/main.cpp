@@ -12,5 +12,8 @@ int main()
             pool.get_var();
         }
         std::cout<< '\n' << "average: "<<pool.average() << '\n';
+        write_text(std::cout, pool.metrics());
     }
+
+    TRACE_EXPORT("trace.json");
 }
\ No newline at end of file
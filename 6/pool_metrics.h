@@ -0,0 +1,222 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Histogram czasów w nanosekundach o przedziałach potęg dwójki:
+// przedział k obejmuje [2^(k-1), 2^k) ns. Pisze tylko jeden wątek (właściciel),
+// więc zapis to zwykłe load + store relaxed bez operacji RMW i można go
+// wołać z gorącej ścieżki; snapshot z innego wątku czyta atomowo.
+class Latency_histogram
+{
+public:
+    static constexpr std::size_t numBuckets = 40;
+
+    struct Snapshot
+    {
+        std::array<std::uint64_t, numBuckets> buckets{};
+        std::uint64_t count{0};
+        std::uint64_t totalNs{0};
+
+        double mean_ns() const
+        {
+            return count ? double(totalNs) / count : 0.0;
+        }
+
+        // Górna granica przedziału, w którym leży zadany percentyl
+        std::uint64_t percentile_ns(double p) const
+        {
+            if (count == 0)
+                return 0;
+            std::uint64_t rank = std::uint64_t(p / 100.0 * count);
+            std::uint64_t seen = 0;
+            for (std::size_t k = 0; k < numBuckets; ++k)
+            {
+                seen += buckets[k];
+                if (seen > rank)
+                    return std::uint64_t(1) << k;
+            }
+            return std::uint64_t(1) << (numBuckets - 1);
+        }
+
+        Snapshot &operator+=(const Snapshot &other)
+        {
+            for (std::size_t k = 0; k < numBuckets; ++k)
+                buckets[k] += other.buckets[k];
+            count += other.count;
+            totalNs += other.totalNs;
+            return *this;
+        }
+    };
+
+private:
+    std::array<std::atomic<std::uint64_t>, numBuckets> buckets{};
+    std::atomic<std::uint64_t> totalNs{0};
+
+public:
+    void record(std::chrono::nanoseconds d)
+    {
+        std::uint64_t ns = d.count() > 0 ? std::uint64_t(d.count()) : 0;
+        std::size_t k = std::bit_width(ns);
+        if (k >= numBuckets)
+            k = numBuckets - 1;
+        buckets[k].store(buckets[k].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        totalNs.store(totalNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot s;
+        for (std::size_t k = 0; k < numBuckets; ++k)
+        {
+            s.buckets[k] = buckets[k].load(std::memory_order_relaxed);
+            s.count += s.buckets[k];
+        }
+        s.totalNs = totalNs.load(std::memory_order_relaxed);
+        return s;
+    }
+};
+
+// Liczniki jednego wątku roboczego. Pisze do nich tylko właściciel,
+// wyrównanie do linii cache zapobiega false sharing między wątkami.
+struct alignas(64) Worker_metrics
+{
+    std::atomic<std::uint64_t> tasksExecuted{0};
+    std::atomic<std::uint64_t> idleNs{0};
+    std::atomic<std::uint64_t> busyNs{0};
+    Latency_histogram execTime;
+    Latency_histogram queueLatency;
+
+    void add(std::atomic<std::uint64_t> &counter, std::uint64_t v)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+};
+
+struct Worker_stats
+{
+    std::uint64_t tasksExecuted{0};
+    std::uint64_t idleNs{0};
+    std::uint64_t busyNs{0};
+};
+
+struct Pool_stats
+{
+    std::vector<Worker_stats> workers;
+    std::size_t liveWorkers{0};
+    std::uint64_t tasksSubmitted{0};
+    std::uint64_t tasksExecuted{0};
+    std::size_t queueDepth{0};
+    std::size_t queueDepthHighWater{0};
+    Latency_histogram::Snapshot execTime;
+    Latency_histogram::Snapshot queueLatency;
+};
+
+inline void write_text(std::ostream &os, const Pool_stats &s)
+{
+    os << "workers: " << s.liveWorkers << " live / " << s.workers.size() << " slots"
+       << "\ntasks submitted: " << s.tasksSubmitted
+       << "\ntasks executed: " << s.tasksExecuted
+       << "\nqueue depth: " << s.queueDepth << " (high water " << s.queueDepthHighWater << ')'
+       << "\nexec time ns: mean " << s.execTime.mean_ns()
+       << " p50 " << s.execTime.percentile_ns(50)
+       << " p99 " << s.execTime.percentile_ns(99)
+       << "\nqueue latency ns: mean " << s.queueLatency.mean_ns()
+       << " p50 " << s.queueLatency.percentile_ns(50)
+       << " p99 " << s.queueLatency.percentile_ns(99) << '\n';
+
+    for (std::size_t i = 0; i < s.workers.size(); ++i)
+        os << "  worker " << i << ": executed " << s.workers[i].tasksExecuted
+           << " busy " << s.workers[i].busyNs / 1000 << " us"
+           << " idle " << s.workers[i].idleNs / 1000 << " us\n";
+}
+
+inline void write_json(std::ostream &os, const Latency_histogram::Snapshot &h)
+{
+    os << "{\"count\":" << h.count << ",\"total_ns\":" << h.totalNs << ",\"buckets\":[";
+    for (std::size_t k = 0; k < Latency_histogram::numBuckets; ++k)
+        os << (k ? "," : "") << h.buckets[k];
+    os << "]}";
+}
+
+inline void write_json(std::ostream &os, const Pool_stats &s)
+{
+    os << "{\"live_workers\":" << s.liveWorkers
+       << ",\"tasks_submitted\":" << s.tasksSubmitted
+       << ",\"tasks_executed\":" << s.tasksExecuted
+       << ",\"queue_depth\":" << s.queueDepth
+       << ",\"queue_depth_high_water\":" << s.queueDepthHighWater
+       << ",\"exec_time\":";
+    write_json(os, s.execTime);
+    os << ",\"queue_latency\":";
+    write_json(os, s.queueLatency);
+    os << ",\"workers\":[";
+    for (std::size_t i = 0; i < s.workers.size(); ++i)
+        os << (i ? "," : "") << "{\"tasks_executed\":" << s.workers[i].tasksExecuted
+           << ",\"busy_ns\":" << s.workers[i].busyNs
+           << ",\"idle_ns\":" << s.workers[i].idleNs << '}';
+    os << "]}\n";
+}
+
+// Okresowy zrzut statystyk na zadany strumień, we własnym wątku.
+class Metrics_reporter
+{
+public:
+    enum class Format
+    {
+        text,
+        json
+    };
+
+private:
+    std::function<Pool_stats()> source;
+    std::ostream &out;
+    Format format;
+    std::chrono::milliseconds interval;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping{false};
+    std::thread thread;
+
+    void dump()
+    {
+        Pool_stats stats = source();
+        if (format == Format::json)
+            write_json(out, stats);
+        else
+            write_text(out, stats);
+        out.flush();
+    }
+
+public:
+    Metrics_reporter(std::function<Pool_stats()> source, std::ostream &out,
+                     std::chrono::milliseconds interval, Format format = Format::text)
+        : source(std::move(source)), out(out), format(format), interval(interval)
+    {
+        thread = std::thread([this] {
+            std::unique_lock<std::mutex> lock{mutex};
+            while (!cv.wait_for(lock, this->interval, [this] { return stopping; }))
+                dump();
+        });
+    }
+
+    ~Metrics_reporter()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+};
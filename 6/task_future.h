@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Pula bloków stanu współdzielonego. Zwolnione bloki trafiają na listę
+// wolnych i są używane ponownie, więc po rozgrzaniu puli kolejne pary
+// promise/future nie sięgają do operatora new.
+template <typename State>
+class State_pool
+{
+private:
+    union Node
+    {
+        Node *next;
+        alignas(State) unsigned char storage[sizeof(State)];
+    };
+
+    std::mutex mutex;
+    Node *freeList{nullptr};
+
+    State_pool() = default;
+
+public:
+    ~State_pool()
+    {
+        while (freeList)
+        {
+            Node *next = freeList->next;
+            delete freeList;
+            freeList = next;
+        }
+    }
+
+    static State_pool &instance()
+    {
+        static State_pool pool;
+        return pool;
+    }
+
+    void *allocate()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (freeList)
+            {
+                Node *node = freeList;
+                freeList = node->next;
+                return node->storage;
+            }
+        }
+        return (new Node)->storage;
+    }
+
+    void deallocate(void *p) noexcept
+    {
+        Node *node = reinterpret_cast<Node *>(p);
+        std::lock_guard<std::mutex> lock(mutex);
+        node->next = freeList;
+        freeList = node;
+    }
+};
+
+// Stan współdzielony przez Task_promise i Task_future. Oczekiwanie na wynik
+// korzysta z std::atomic::wait zamiast pary mutex/condition_variable.
+template <typename T>
+class Task_state
+{
+private:
+    using Value = std::conditional_t<std::is_void_v<T>, char, T>;
+
+    std::atomic<int> refs{1};
+    std::atomic<bool> ready{false};
+    std::exception_ptr error;
+    alignas(Value) unsigned char value[sizeof(Value)];
+
+public:
+    ~Task_state()
+    {
+        if (ready.load(std::memory_order_relaxed) && !error)
+            reinterpret_cast<Value *>(value)->~Value();
+    }
+
+    static Task_state *create()
+    {
+        return ::new (State_pool<Task_state>::instance().allocate()) Task_state;
+    }
+
+    void retain() noexcept
+    {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept
+    {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            this->~Task_state();
+            State_pool<Task_state>::instance().deallocate(this);
+        }
+    }
+
+    template <typename... U>
+    void set_value(U &&...v)
+    {
+        ::new (static_cast<void *>(value)) Value(std::forward<U>(v)...);
+        ready.store(true, std::memory_order_release);
+        ready.notify_all();
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+        error = std::move(e);
+        ready.store(true, std::memory_order_release);
+        ready.notify_all();
+    }
+
+    bool is_ready() const
+    {
+        return ready.load(std::memory_order_acquire);
+    }
+
+    void wait() const
+    {
+        ready.wait(false, std::memory_order_acquire);
+    }
+
+    T get()
+    {
+        wait();
+        if (error)
+            std::rethrow_exception(error);
+        if constexpr (!std::is_void_v<T>)
+            return std::move(*reinterpret_cast<Value *>(value));
+    }
+};
+
+template <typename T>
+class Task_future
+{
+private:
+    Task_state<T> *state{nullptr};
+
+public:
+    Task_future() = default;
+    explicit Task_future(Task_state<T> *s) : state(s) {}
+
+    Task_future(Task_future &&other) noexcept : state(std::exchange(other.state, nullptr)) {}
+
+    Task_future &operator=(Task_future &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (state)
+                state->release();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task_future()
+    {
+        if (state)
+            state->release();
+    }
+
+    bool valid() const { return state != nullptr; }
+    bool is_ready() const { return state->is_ready(); }
+    void wait() const { state->wait(); }
+
+    // Wynik można odebrać tylko raz, tak jak w std::future
+    T get()
+    {
+        Task_state<T> *s = std::exchange(state, nullptr);
+        struct Releaser
+        {
+            Task_state<T> *s;
+            ~Releaser() { s->release(); }
+        } releaser{s};
+        return s->get();
+    }
+};
+
+template <typename T>
+class Task_promise
+{
+private:
+    Task_state<T> *state;
+
+public:
+    Task_promise() : state(Task_state<T>::create()) {}
+
+    Task_promise(Task_promise &&other) noexcept : state(std::exchange(other.state, nullptr)) {}
+    Task_promise &operator=(Task_promise &&) = delete;
+
+    ~Task_promise()
+    {
+        if (state)
+        {
+            if (!state->is_ready())
+                state->set_exception(std::make_exception_ptr(
+                    std::future_error(std::future_errc::broken_promise)));
+            state->release();
+        }
+    }
+
+    // Może zostać wywołane tylko raz, przed przekazaniem obietnicy do zadania
+    Task_future<T> get_future()
+    {
+        state->retain();
+        return Task_future<T>(state);
+    }
+
+    template <typename... U>
+    void set_value(U &&...v)
+    {
+        state->set_value(std::forward<U>(v)...);
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+        state->set_exception(std::move(e));
+    }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Kolejka FIFO na buforze cyklicznym. W odróżnieniu od std::queue (deque)
+// nie zwalnia i nie alokuje bloków w trakcie pracy - bufor rośnie tylko
+// wtedy, gdy zabraknie miejsca.
+template <typename T>
+class Task_queue
+{
+private:
+    std::vector<T> buffer;
+    std::size_t head{0};
+    std::size_t count{0};
+
+    void grow()
+    {
+        std::vector<T> bigger(buffer.empty() ? 64 : buffer.size() * 2);
+        for (std::size_t i = 0; i < count; ++i)
+            bigger[i] = std::move(buffer[(head + i) % buffer.size()]);
+        buffer = std::move(bigger);
+        head = 0;
+    }
+
+public:
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    T &front() { return buffer[head]; }
+
+    void push(T &&item)
+    {
+        if (count == buffer.size())
+            grow();
+        buffer[(head + count) % buffer.size()] = std::move(item);
+        ++count;
+    }
+
+    T pop()
+    {
+        T item = std::move(buffer[head]);
+        head = (head + 1) % buffer.size();
+        --count;
+        return item;
+    }
+};
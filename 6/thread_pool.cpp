@@ -1,9 +1,24 @@
 #include "thread_pool.h"
+#include "trace.h"
 
 
 Thread_pool::Thread_pool(std::size_t numThreads)
+    : Thread_pool(numThreads, numThreads)
 {
-    start(numThreads);
+};
+
+Thread_pool::Thread_pool(std::size_t minThreads, std::size_t maxThreads,
+                         Clock::duration idleTimeout, Affinity affinity)
+    : mMinThreads(minThreads), mMaxThreads(std::max(minThreads, maxThreads)),
+      mIdleTimeout(idleTimeout), mAffinity(affinity)
+{
+    if (mAffinity == Affinity::cores)
+        for (int cpu : allowed_cpus())
+            mCpuGroups.push_back({cpu});
+    else if (mAffinity == Affinity::numa)
+        mCpuGroups = numa_nodes();
+
+    start(mMinThreads);
 };
 
 Thread_pool::~Thread_pool()
@@ -11,22 +26,117 @@ Thread_pool::~Thread_pool()
     stop();
 };
 
-void Thread_pool::add_task(std::function<double()> task)
+void Thread_pool::enqueue(Task task, Priority priority)
 {
-    auto wrapper = std::make_shared<std::packaged_task<decltype(task()) ()>>(std::move(task));
+    std::size_t slot = mMaxThreads;
 
     {
         std::unique_lock<std::mutex> lock{mEventMutex};
-        mTasks.emplace([=] {
-            (*wrapper)();
-        });
+        mTasks[std::size_t(priority)].push({std::move(task), Clock::now(), {}});
+        mTasksSubmitted++;
+        if (++mQueued > mQueueHighWater)
+            mQueueHighWater = mQueued;
+        slot = reserve_slot();
     }
 
     mEventVar.notify_one();
-    futuresTotalScore += (wrapper->get_future()).get();
-    futuresNum ++;
+    if (slot != mMaxThreads)
+        spawn_worker(slot);
+}
+
+bool Thread_pool::later_deadline(const Queued_task &a, const Queued_task &b)
+{
+    return a.deadline > b.deadline;
 }
 
+void Thread_pool::enqueue_deadline(Task task, Clock::time_point deadline)
+{
+    std::size_t slot = mMaxThreads;
+
+    {
+        std::unique_lock<std::mutex> lock{mEventMutex};
+        mDeadlineTasks.push_back({std::move(task), Clock::now(), deadline});
+        std::push_heap(mDeadlineTasks.begin(), mDeadlineTasks.end(), later_deadline);
+        mTasksSubmitted++;
+        if (++mQueued > mQueueHighWater)
+            mQueueHighWater = mQueued;
+        slot = reserve_slot();
+    }
+
+    mEventVar.notify_one();
+    if (slot != mMaxThreads)
+        spawn_worker(slot);
+}
+
+// Wywoływane pod mEventMutex. Nowy wątek powstaje, gdy jest zaległa praca,
+// a żaden wątek na nią nie czeka (wszystkie zajęte, np. długim zadaniem albo
+// czekaniem na zadanie zagnieżdżone). Tłumienie: dopóki poprzednio
+// utworzony wątek nie dotarł do kolejki, kolejnego nie tworzymy.
+// Zwraca zarezerwowany slot albo mMaxThreads.
+std::size_t Thread_pool::reserve_slot()
+{
+    if (mStopping || mIdle != 0 || mStarting != 0 || mQueued == 0 || mFreeSlots.empty())
+        return mMaxThreads;
+
+    std::size_t slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    mLive++;
+    mStarting++;
+    return slot;
+}
+
+// Wywoływane pod mEventMutex, gdy mQueued > 0
+Thread_pool::Queued_task Thread_pool::pop_next()
+{
+    mQueued--;
+
+    // Priorytet efektywny = poziom kolejki minus liczba kroków starzenia,
+    // które odczekało najstarsze zadanie, ale nie mniej niż 0: postarzałe
+    // zadanie może najwyżej zrównać się z high, a remis wygrywa high. Między
+    // normal i low przy remisie wygrywa starsze zadanie, więc low nie głodnieje.
+    auto now = Clock::now();
+    std::size_t best = numPriorities;
+    long bestScore = 0;
+    for (std::size_t level = 0; level < numPriorities; ++level)
+    {
+        if (mTasks[level].empty())
+            continue;
+        long aged = long((now - mTasks[level].front().enqueued) / mAgingStep);
+        long score = level == 0 ? 0 : std::max(0L, long(level) - aged);
+        if (best == numPriorities || score < bestScore ||
+            (score == bestScore && best != 0 &&
+             mTasks[level].front().enqueued < mTasks[best].front().enqueued))
+        {
+            best = level;
+            bestScore = score;
+        }
+    }
+
+    // Zadanie z terminem: o poziom przed high, gdy termin mija, a później
+    // o jeden poziom niżej za każdy krok starzenia zapasu do terminu. Odległe
+    // terminy nie głodzą więc kolejek, a przy remisie wygrywa termin.
+    if (!mDeadlineTasks.empty())
+    {
+        long deadlineScore = -1 + long((mDeadlineTasks.front().deadline - now) / mAgingStep);
+        if (best == numPriorities || deadlineScore <= bestScore)
+        {
+            std::pop_heap(mDeadlineTasks.begin(), mDeadlineTasks.end(), later_deadline);
+            Queued_task task = std::move(mDeadlineTasks.back());
+            mDeadlineTasks.pop_back();
+            return task;
+        }
+    }
+
+    return mTasks[best].pop();
+}
+
+void Thread_pool::set_aging_step(Clock::duration step)
+{
+    if (step <= Clock::duration::zero())
+        throw std::invalid_argument("aging step must be positive");
+    std::unique_lock<std::mutex> lock{mEventMutex};
+    mAgingStep = step;
+}
 
 double Thread_pool::average()
 {
@@ -42,43 +152,194 @@ void Thread_pool::stop(){
  
     mEventVar.notify_all();
 
-    for (auto &thread : mThreads)
-        thread.join();
+    // spawn_worker wywołany tuż przed zatrzymaniem może jeszcze utworzyć wątek,
+    // więc zbieramy wątki do skutku, aż żaden nie zostanie żywy
+    while (true)
+    {
+        std::vector<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> threadsLock{mThreadsMutex};
+            for (auto &thread : mThreads)
+                if (thread.joinable())
+                    finished.push_back(std::move(thread));
+        }
+
+        for (auto &thread : finished)
+            thread.join();
+
+        {
+            std::unique_lock<std::mutex> lock{mEventMutex};
+            if (mLive == 0)
+                break;
+        }
+        std::this_thread::yield();
+    }
 
 };
 
 void Thread_pool::start(std::size_t numThreads)
 {
+    mThreads.resize(mMaxThreads);
+    for (auto i = 0u; i < mMaxThreads; ++i)
+        mWorkerMetrics.push_back(std::make_unique<Worker_metrics>());
+    for (auto i = mMaxThreads; i > 0; --i)
+        mFreeSlots.push_back(i - 1);
+
     for (auto i = 0u; i < numThreads; ++i)
     {
-        mThreads.emplace_back([=] 
+        std::size_t slot;
         {
-            bool continueExecution = true;
-            while (continueExecution)
-            {
-                Task task;
+            std::unique_lock<std::mutex> lock{mEventMutex};
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+            mLive++;
+            mStarting++;
+        }
+        spawn_worker(slot);
+    }
+};
 
-                {
-                    std::unique_lock<std::mutex> lock{mEventMutex};
+void Thread_pool::spawn_worker(std::size_t slot)
+{
+    std::lock_guard<std::mutex> threadsLock{mThreadsMutex};
+
+    // wątki zbędne same się odłączają, ale zachowawczo dołączamy poprzednika
+    if (mThreads[slot].joinable())
+        mThreads[slot].join();
+
+    {
+        std::unique_lock<std::mutex> lock{mEventMutex};
+        if (mStopping)
+        {
+            mLive--;
+            mStarting--;
+            mFreeSlots.push_back(slot);
+            return;
+        }
+    }
+
+    mThreads[slot] = std::thread([this, slot] { worker_loop(slot); });
+}
+
+void Thread_pool::pin_worker(std::size_t slot)
+{
+    if (!mCpuGroups.empty())
+        pin_current_thread(mCpuGroups[slot % mCpuGroups.size()]);
+}
+
+void Thread_pool::worker_loop(std::size_t slot)
+{
+    pin_worker(slot);
 
-                    mEventVar.wait(lock, [=] { return mStopping || !mTasks.empty(); });
+    {
+        std::unique_lock<std::mutex> lock{mEventMutex};
+        mStarting--;
+    }
 
-                    if (mStopping && mTasks.empty())
-                        continueExecution = false;
-                    else{
-                        task = std::move(mTasks.front());
-                        mTasks.pop();
+    Worker_metrics &metrics = *mWorkerMetrics[slot];
+    bool continueExecution = true;
+    while (continueExecution)
+    {
+        Queued_task queued;
+        std::size_t spawnSlot = mMaxThreads;
+        auto idleStart = Clock::now();
+
+        {
+            std::unique_lock<std::mutex> lock{mEventMutex};
+
+            auto ready = [this] { return mStopping || mQueued != 0; };
+            mIdle++;
+            while (!ready())
+            {
+                if (mLive > mMinThreads)
+                {
+                    if (mEventVar.wait_for(lock, mIdleTimeout) == std::cv_status::timeout &&
+                        !ready() && mLive > mMinThreads)
+                    {
+                        // Wątek zbędny: odłącza się, więc system od razu zwalnia jego
+                        // stos. Blokady w kolejności jak w spawn_worker, a warunek
+                        // sprawdzany ponownie, bo w międzyczasie mogła przyjść praca.
+                        lock.unlock();
+                        std::lock_guard<std::mutex> threadsLock{mThreadsMutex};
+                        lock.lock();
+                        if (!ready() && mLive > mMinThreads)
+                        {
+                            mIdle--;
+                            mLive--;
+                            mThreads[slot].detach();
+                            mFreeSlots.push_back(slot);
+                            return;
+                        }
                     }
-                
                 }
+                else
+                    mEventVar.wait(lock);
+            }
+            mIdle--;
 
-                if(continueExecution)
-                    task();
+            if (mStopping && mQueued == 0)
+            {
+                mLive--;
+                continueExecution = false;
             }
-        });
+            else{
+                queued = pop_next();
+                TRACE_COUNTER("Thread_pool queued", mQueued);
+                // zaległości zostały, a nikt nie czeka - kolejny wątek
+                spawnSlot = reserve_slot();
+            }
+        
+        }
+
+        if (spawnSlot != mMaxThreads)
+            spawn_worker(spawnSlot);
+
+        if(continueExecution)
+        {
+            auto taskStart = Clock::now();
+            {
+                TRACE_SPAN("Thread_pool task");
+                queued.task();
+            }
+            auto taskEnd = Clock::now();
+
+            metrics.add(metrics.idleNs, std::chrono::nanoseconds(taskStart - idleStart).count());
+            metrics.add(metrics.busyNs, std::chrono::nanoseconds(taskEnd - taskStart).count());
+            metrics.add(metrics.tasksExecuted, 1);
+            metrics.execTime.record(taskEnd - taskStart);
+            metrics.queueLatency.record(taskStart - queued.enqueued);
+        }
     }
 };
 
+Pool_stats Thread_pool::metrics()
+{
+    Pool_stats stats;
+
+    {
+        std::unique_lock<std::mutex> lock{mEventMutex};
+        stats.tasksSubmitted = mTasksSubmitted;
+        stats.queueDepth = mQueued;
+        stats.queueDepthHighWater = mQueueHighWater;
+        stats.liveWorkers = mLive;
+    }
+
+    for (auto &worker : mWorkerMetrics)
+    {
+        Worker_stats w;
+        w.tasksExecuted = worker->tasksExecuted.load(std::memory_order_relaxed);
+        w.idleNs = worker->idleNs.load(std::memory_order_relaxed);
+        w.busyNs = worker->busyNs.load(std::memory_order_relaxed);
+        stats.tasksExecuted += w.tasksExecuted;
+        stats.workers.push_back(w);
+
+        stats.execTime += worker->execTime.snapshot();
+        stats.queueLatency += worker->queueLatency.snapshot();
+    }
+
+    return stats;
+}
+
 void Thread_pool::get_var()
 {
     std::cout << "futuresTotalScore: " << futuresTotalScore <<"\nfutureNum: " << futuresNum << '\n';
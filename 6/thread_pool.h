@@ -1,19 +1,75 @@
+#pragma once
+
 #include <functional>
+#include <iostream>
 #include <thread>
 #include <vector>
 #include <condition_variable>
-#include <queue>
-#include <future>
+#include <mutex>
+#include <type_traits>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "unique_function.h"
+#include "task_future.h"
+#include "task_queue.h"
+#include "pool_metrics.h"
+#include "cpu_topology.h"
 
 class Thread_pool
 {
 public:
-    using Task = std::function<void()>;
+    using Task = Unique_function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    enum class Priority
+    {
+        high,
+        normal,
+        low
+    };
+    static constexpr std::size_t numPriorities = 3;
+
+    // Przypinanie wątków: brak, każdy wątek do jednego rdzenia,
+    // albo wątki rozłożone po węzłach NUMA (cały węzeł na wątek)
+    enum class Affinity
+    {
+        none,
+        cores,
+        numa
+    };
 
 private:
+    struct Queued_task
+    {
+        Task task;
+        Clock::time_point enqueued;
+        Clock::time_point deadline;
+    };
+
+    // mThreads ma stały rozmiar maxThreads; wolne sloty czekają w mFreeSlots.
+    // Obiekty std::thread zmieniane są tylko pod mThreadsMutex.
     std::vector<std::thread> mThreads;
+    std::mutex mThreadsMutex;
+    std::vector<std::size_t> mFreeSlots;
+    std::size_t mMinThreads;
+    std::size_t mMaxThreads;
+    std::size_t mLive{0};
+    std::size_t mIdle{0};
+    // wątki utworzone, które jeszcze nie doszły do pętli pracy
+    std::size_t mStarting{0};
+    Clock::duration mIdleTimeout;
+    Affinity mAffinity;
+    std::vector<std::vector<int>> mCpuGroups;
+
     std::mutex mEventMutex;
-    std::queue<Task> mTasks;
+    // jedna kolejka FIFO na poziom priorytetu + kopiec zadań z terminem (EDF)
+    Task_queue<Queued_task> mTasks[numPriorities];
+    std::vector<Queued_task> mDeadlineTasks;
+    std::size_t mQueued{0};
+    Clock::duration mAgingStep{std::chrono::milliseconds(100)};
 
     std::condition_variable mEventVar;
     bool mStopping{false};
@@ -21,21 +77,120 @@ private:
     double futuresTotalScore{0};
     double futuresNum{0};
 
+    std::vector<std::unique_ptr<Worker_metrics>> mWorkerMetrics;
+    std::uint64_t mTasksSubmitted{0};
+    std::size_t mQueueHighWater{0};
+
 public:
     explicit Thread_pool(std::size_t numThreads);
+    // Pula elastyczna: przy zaległościach dokłada wątki aż do maxThreads,
+    // wątek bezczynny dłużej niż idleTimeout kończy się (ale nie poniżej minThreads)
+    Thread_pool(std::size_t minThreads, std::size_t maxThreads,
+                Clock::duration idleTimeout = std::chrono::seconds(30),
+                Affinity affinity = Affinity::none);
     ~Thread_pool();
 
-    void add_task(std::function<double()> task);
+    template <typename F>
+    auto submit(F &&task, Priority priority = Priority::normal)
+        -> Task_future<std::invoke_result_t<std::decay_t<F> &>>;
+
+    // Zadanie bez wyniku i bez future - np. dla timerów
+    template <typename F>
+    void post(F &&task, Priority priority = Priority::normal);
+
+    // Zadania z terminem wykonywane są w kolejności najwcześniejszego terminu;
+    // z kolejkami priorytetów konkurują zapasem czasu do terminu, liczonym
+    // w krokach starzenia (termin bieżący wyprzedza nawet Priority::high)
+    template <typename F>
+    auto submit_before(Clock::time_point deadline, F &&task)
+        -> Task_future<std::invoke_result_t<std::decay_t<F> &>>;
+
+    // Co tyle czasu oczekiwania zadanie awansuje o jeden poziom priorytetu;
+    // krok musi być dodatni (inaczej std::invalid_argument)
+    void set_aging_step(Clock::duration step);
+
+    template <typename F>
+    void add_task(F &&task);
 
     double average();
     void stop();
 
+    Pool_stats metrics();
     void get_var();
     
 private:
     void start(std::size_t numThreads);
+    void spawn_worker(std::size_t slot);
+    void worker_loop(std::size_t slot);
+    void pin_worker(std::size_t slot);
+    void enqueue(Task task, Priority priority);
+    void enqueue_deadline(Task task, Clock::time_point deadline);
+    std::size_t reserve_slot();
+    Queued_task pop_next();
+    static bool later_deadline(const Queued_task &a, const Queued_task &b);
+
+    template <typename F>
+    static auto package(F &&task, Task &out) -> Task_future<std::invoke_result_t<std::decay_t<F> &>>;
     
 };
 
+template <typename F>
+auto Thread_pool::package(F &&task, Task &out) -> Task_future<std::invoke_result_t<std::decay_t<F> &>>
+{
+    using Result = std::invoke_result_t<std::decay_t<F> &>;
+
+    Task_promise<Result> promise;
+    auto future = promise.get_future();
 
+    out = Task([promise = std::move(promise), task = std::forward<F>(task)]() mutable {
+        try
+        {
+            if constexpr (std::is_void_v<Result>)
+            {
+                task();
+                promise.set_value();
+            }
+            else
+                promise.set_value(task());
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    });
+
+    return future;
+}
+
+template <typename F>
+auto Thread_pool::submit(F &&task, Priority priority)
+    -> Task_future<std::invoke_result_t<std::decay_t<F> &>>
+{
+    Task wrapped;
+    auto future = package(std::forward<F>(task), wrapped);
+    enqueue(std::move(wrapped), priority);
+    return future;
+}
 
+template <typename F>
+void Thread_pool::post(F &&task, Priority priority)
+{
+    enqueue(Task(std::forward<F>(task)), priority);
+}
+
+template <typename F>
+auto Thread_pool::submit_before(Clock::time_point deadline, F &&task)
+    -> Task_future<std::invoke_result_t<std::decay_t<F> &>>
+{
+    Task wrapped;
+    auto future = package(std::forward<F>(task), wrapped);
+    enqueue_deadline(std::move(wrapped), deadline);
+    return future;
+}
+
+template <typename F>
+void Thread_pool::add_task(F &&task)
+{
+    futuresTotalScore += submit(std::forward<F>(task)).get();
+    futuresNum ++;
+}
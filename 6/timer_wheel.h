@@ -0,0 +1,360 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.h"
+
+// Hierarchiczne koło czasowe (4 poziomy po 64 przedziały). Jeden wątek
+// odmierza takty, a wygasłe zadania przekazuje do wspólnej Thread_pool,
+// więc liczba wątków nie zależy od liczby timerów.
+class Timer_wheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = Unique_function<void()>;
+    using Timer_id = std::uint64_t;
+
+    static constexpr Timer_id invalid_timer = 0;
+
+private:
+    static constexpr unsigned levelBits = 6;
+    static constexpr std::size_t slotsPerLevel = std::size_t(1) << levelBits;
+    static constexpr std::uint64_t slotMask = slotsPerLevel - 1;
+    static constexpr std::size_t numLevels = 4;
+    static constexpr std::uint32_t none = ~std::uint32_t(0);
+
+    enum class State
+    {
+        free,
+        scheduled,
+        running,
+    };
+
+    struct Timer_node
+    {
+        Task task;
+        std::uint64_t expiry{0};
+        std::uint64_t period{0};
+        std::uint32_t prev{none};
+        std::uint32_t next{none};
+        std::uint32_t generation{1};
+        std::uint32_t self{0};
+        std::uint32_t *bucket{nullptr};
+        State state{State::free};
+        bool cancelled{false};
+        std::atomic<std::thread::id> runner;
+    };
+
+    Thread_pool &pool;
+    Clock::duration tick;
+    Clock::time_point origin;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    // deque nie przenosi elementów przy dokładaniu, więc wskaźniki do węzłów są stałe
+    std::deque<Timer_node> nodes;
+    std::vector<std::uint32_t> freeNodes;
+    std::array<std::array<std::uint32_t, slotsPerLevel>, numLevels> slots;
+    std::vector<std::uint32_t> overflow;
+    std::uint64_t now{0};
+    std::vector<Timer_node *> due;
+
+    bool stopping{false};
+    std::condition_variable wakeup;
+    std::thread thread;
+
+    static Timer_id make_id(const Timer_node &n)
+    {
+        return (std::uint64_t(n.generation) << 32) | n.self;
+    }
+
+    Timer_node *find(Timer_id id)
+    {
+        std::uint32_t index = std::uint32_t(id);
+        if (index >= nodes.size())
+            return nullptr;
+        Timer_node &n = nodes[index];
+        if (n.state == State::free || n.generation != std::uint32_t(id >> 32))
+            return nullptr;
+        return &n;
+    }
+
+    std::uint64_t to_ticks(Clock::duration d) const
+    {
+        auto t = (d + tick - Clock::duration(1)) / tick;
+        return t > 0 ? std::uint64_t(t) : 0;
+    }
+
+    std::uint32_t allocate_node()
+    {
+        if (!freeNodes.empty())
+        {
+            std::uint32_t index = freeNodes.back();
+            freeNodes.pop_back();
+            return index;
+        }
+        nodes.emplace_back();
+        nodes.back().self = std::uint32_t(nodes.size() - 1);
+        return nodes.back().self;
+    }
+
+    void free_node(Timer_node &n)
+    {
+        n.task.reset();
+        n.state = State::free;
+        n.cancelled = false;
+        n.generation++;
+        freeNodes.push_back(n.self);
+    }
+
+    std::uint32_t *slot_for(std::uint64_t expiry)
+    {
+        if (expiry < now)
+            expiry = now;
+        std::uint64_t delta = expiry - now;
+        for (std::size_t level = 0; level < numLevels; ++level)
+            if (delta < (std::uint64_t(1) << (levelBits * (level + 1))))
+                return &slots[level][(expiry >> (levelBits * level)) & slotMask];
+        return nullptr;
+    }
+
+    void link(Timer_node &n)
+    {
+        n.state = State::scheduled;
+        std::uint32_t *head = slot_for(n.expiry);
+        n.bucket = head;
+        if (!head)
+        {
+            n.prev = n.next = none;
+            overflow.push_back(n.self);
+            return;
+        }
+        n.prev = none;
+        n.next = *head;
+        if (*head != none)
+            nodes[*head].prev = n.self;
+        *head = n.self;
+    }
+
+    void unlink(Timer_node &n)
+    {
+        std::uint32_t *head = n.bucket;
+        if (!head)
+        {
+            std::erase(overflow, n.self);
+            return;
+        }
+        if (n.prev != none)
+            nodes[n.prev].next = n.next;
+        else
+            *head = n.next;
+        if (n.next != none)
+            nodes[n.next].prev = n.prev;
+        n.prev = n.next = none;
+    }
+
+    // Przenosi timery z przedziału wyższego poziomu na niższe
+    void cascade(std::size_t level, std::size_t index)
+    {
+        std::uint32_t i = slots[level][index];
+        slots[level][index] = none;
+        while (i != none)
+        {
+            std::uint32_t next = nodes[i].next;
+            link(nodes[i]);
+            i = next;
+        }
+    }
+
+    // Przetwarza takt `now` i przechodzi do następnego; wołane pod mutexem
+    void advance()
+    {
+        if ((now & slotMask) == 0)
+        {
+            std::size_t level = 1;
+            for (; level < numLevels; ++level)
+            {
+                std::size_t index = (now >> (levelBits * level)) & slotMask;
+                cascade(level, index);
+                if (index != 0)
+                    break;
+            }
+            if (level == numLevels)
+            {
+                std::vector<std::uint32_t> far;
+                far.swap(overflow);
+                for (std::uint32_t i : far)
+                    link(nodes[i]);
+            }
+        }
+
+        std::uint32_t &head = slots[0][now & slotMask];
+        std::uint32_t i = head;
+        head = none;
+        while (i != none)
+        {
+            Timer_node &n = nodes[i];
+            i = n.next;
+            n.prev = n.next = none;
+            n.bucket = nullptr;
+            n.state = State::running;
+            n.runner.store(std::thread::id(), std::memory_order_relaxed);
+            due.push_back(&n);
+        }
+        now++;
+    }
+
+    void run(Timer_node *n)
+    {
+        {
+            // anulowany, zanim pula doszła do zadania - cancel już nie czeka
+            std::lock_guard<std::mutex> lock{mutex};
+            if (n->cancelled)
+            {
+                free_node(*n);
+                finished.notify_all();
+                return;
+            }
+            n->runner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+
+        n->task();
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (n->cancelled || n->period == 0 || stopping)
+        {
+            free_node(*n);
+            finished.notify_all();
+        }
+        else
+        {
+            n->expiry = now + n->period;
+            link(*n);
+        }
+    }
+
+    void dispatch()
+    {
+        for (Timer_node *n : due)
+            pool.post([this, n] { run(n); });
+        due.clear();
+    }
+
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!stopping)
+        {
+            std::uint64_t target = std::uint64_t((Clock::now() - origin) / tick);
+            while (now <= target)
+                advance();
+
+            if (!due.empty())
+            {
+                lock.unlock();
+                dispatch();
+                lock.lock();
+            }
+
+            wakeup.wait_until(lock, origin + tick * now, [this] { return stopping; });
+        }
+    }
+
+    Timer_id add(Clock::duration delay, Clock::duration period, Task task)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        Timer_node &n = nodes[allocate_node()];
+        n.task = std::move(task);
+        n.period = period.count() > 0 ? std::max<std::uint64_t>(1, to_ticks(period)) : 0;
+        n.expiry = now + to_ticks(delay);
+        link(n);
+        return make_id(n);
+    }
+
+public:
+    explicit Timer_wheel(Thread_pool &pool, Clock::duration tick = std::chrono::milliseconds(1))
+        : pool(pool), tick(tick), origin(Clock::now())
+    {
+        for (auto &level : slots)
+            level.fill(none);
+        thread = std::thread([this] { loop(); });
+    }
+
+    ~Timer_wheel()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        wakeup.notify_all();
+        thread.join();
+
+        // czekamy, aż zadania przekazane już do puli się zakończą
+        std::unique_lock<std::mutex> lock{mutex};
+        finished.wait(lock, [this] {
+            for (auto &n : nodes)
+                if (n.state == State::running)
+                    return false;
+            return true;
+        });
+    }
+
+    Timer_wheel(const Timer_wheel &) = delete;
+    Timer_wheel &operator=(const Timer_wheel &) = delete;
+
+    // Jednorazowe zadanie po upływie delay
+    template <typename F>
+    Timer_id schedule_after(Clock::duration delay, F &&f)
+    {
+        return add(delay, Clock::duration::zero(), Task(std::forward<F>(f)));
+    }
+
+    // Zadanie cykliczne; kolejne wykonanie planowane jest `period` po
+    // zakończeniu poprzedniego, więc wykonania jednego timera się nie nakładają
+    template <typename F>
+    Timer_id schedule_every(Clock::duration period, F &&f)
+    {
+        return add(period, period, Task(std::forward<F>(f)));
+    }
+
+    // Usuwa timer. Jeśli jego zadanie właśnie się wykonuje, czeka na koniec
+    // (chyba że cancel woła samo zadanie); zadanie czekające jeszcze w kolejce
+    // puli już się nie wykona. Zwraca false dla nieznanego id.
+    bool cancel(Timer_id id)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        Timer_node *n = find(id);
+        if (!n)
+            return false;
+
+        if (n->state == State::scheduled)
+        {
+            unlink(*n);
+            free_node(*n);
+            return true;
+        }
+
+        n->cancelled = true;
+        // czekanie na zadanie, które pula dopiero uruchomi, mogłoby zakleszczyć
+        // wątek puli wołający cancel
+        std::thread::id runner = n->runner.load(std::memory_order_relaxed);
+        if (runner != std::thread::id() && runner != std::this_thread::get_id())
+            finished.wait(lock, [&] { return find(id) == nullptr; });
+        return true;
+    }
+
+    std::size_t active()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return nodes.size() - freeNodes.size();
+    }
+};
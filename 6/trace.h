@@ -0,0 +1,253 @@
+#pragma once
+
+// Śledzenie wykonania: zakresy (TRACE_SPAN), zdarzenia chwilowe
+// (TRACE_INSTANT) i liczniki (TRACE_COUNTER) zapisywane do buforów
+// poszczególnych wątków, eksportowane jako JSON w formacie Chrome
+// trace_event (chrome://tracing, ui.perfetto.dev).
+//
+// Włączane przy kompilacji: -DCPPLAB_TRACE. Bez tego makra TRACE_* nie
+// generują żadnego kodu, a ich argumenty nie są nawet obliczane.
+//
+// Nazwy zdarzeń muszą być literałami - zapisywany jest tylko wskaźnik.
+
+#ifdef CPPLAB_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+class Tracer
+{
+public:
+    enum class Kind : char
+    {
+        span = 'X',
+        instant = 'i',
+        counter = 'C'
+    };
+
+    struct Event
+    {
+        const char *name;
+        const char *argName;
+        std::int64_t arg;
+        std::uint64_t startNs;
+        std::uint64_t durationNs;
+        Kind kind;
+    };
+
+private:
+    // Pierwszy kawałek jest mały (16 zdarzeń, <1 KB), każdy następny dwa
+    // razy większy aż do maksimum, więc krótki wątek z kilkoma zdarzeniami
+    // (np. asyncFunction) nie płaci za pełny bufor, a długo śledzony
+    // alokuje rzadko.
+    static constexpr std::size_t firstChunkEvents = 16;
+    static constexpr std::size_t maxChunkEvents = 4096;
+
+    // Bufor wątku to lista kawałków. Pisze tylko właściciel: najpierw
+    // zdarzenie, potem licznik (release), więc eksport może czytać
+    // równolegle - widzi wszystko do opublikowanego licznika.
+    struct Chunk
+    {
+        const std::size_t capacity;
+        const std::unique_ptr<Event[]> events;
+        std::atomic<std::size_t> count{0};
+        std::atomic<Chunk *> next{nullptr};
+
+        explicit Chunk(std::size_t capacity) : capacity(capacity), events(new Event[capacity]) {}
+    };
+
+    struct Thread_buffer
+    {
+        unsigned int tid;
+        Chunk *head;
+        Chunk *tail;
+
+        explicit Thread_buffer(unsigned int tid) : tid(tid), head(new Chunk(firstChunkEvents)), tail(head) {}
+
+        ~Thread_buffer()
+        {
+            while (head)
+                delete std::exchange(head, head->next.load(std::memory_order_relaxed));
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point mStart{Clock::now()};
+    std::mutex mBuffersMutex;
+    // bufory zakończonych wątków zostają - ich zdarzenia też trafiają do eksportu
+    std::vector<std::unique_ptr<Thread_buffer>> mBuffers;
+
+    Tracer() = default;
+
+    Thread_buffer &local()
+    {
+        thread_local Thread_buffer *mine = nullptr;
+        if (!mine)
+        {
+            std::lock_guard<std::mutex> lock{mBuffersMutex};
+            mBuffers.push_back(std::make_unique<Thread_buffer>(unsigned(mBuffers.size() + 1)));
+            mine = mBuffers.back().get();
+        }
+        return *mine;
+    }
+
+    static void write_string(std::ostream &os, const char *s)
+    {
+        os << '"';
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                os << '\\';
+            os << *s;
+        }
+        os << '"';
+    }
+
+    static void write_us(std::ostream &os, std::uint64_t ns)
+    {
+        os << ns / 1000 << '.' << char('0' + ns / 100 % 10) << char('0' + ns / 10 % 10) << char('0' + ns % 10);
+    }
+
+    static void write_event(std::ostream &os, unsigned int tid, const Event &e)
+    {
+        os << "{\"name\":";
+        write_string(os, e.name);
+        os << ",\"ph\":\"" << char(e.kind) << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+        write_us(os, e.startNs);
+        if (e.kind == Kind::span)
+        {
+            os << ",\"dur\":";
+            write_us(os, e.durationNs);
+        }
+        else if (e.kind == Kind::instant)
+            os << ",\"s\":\"t\"";
+        if (e.argName)
+        {
+            os << ",\"args\":{";
+            write_string(os, e.argName);
+            os << ':' << e.arg << '}';
+        }
+        os << '}';
+    }
+
+public:
+    // Nigdy nie niszczony: zakresy mogą się kończyć jeszcze w destruktorach
+    // obiektów statycznych
+    static Tracer &global()
+    {
+        static Tracer *tracer = new Tracer;
+        return *tracer;
+    }
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    std::uint64_t now_ns() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - mStart).count();
+    }
+
+    void record(const Event &e)
+    {
+        Thread_buffer &buffer = local();
+        Chunk *chunk = buffer.tail;
+        std::size_t n = chunk->count.load(std::memory_order_relaxed);
+        if (n == chunk->capacity)
+        {
+            Chunk *fresh = new Chunk(std::min(2 * chunk->capacity, maxChunkEvents));
+            chunk->next.store(fresh, std::memory_order_release);
+            buffer.tail = chunk = fresh;
+            n = 0;
+        }
+        chunk->events[n] = e;
+        chunk->count.store(n + 1, std::memory_order_release);
+    }
+
+    void instant(const char *name)
+    {
+        record({name, nullptr, 0, now_ns(), 0, Kind::instant});
+    }
+
+    void counter(const char *name, std::int64_t value)
+    {
+        record({name, "value", value, now_ns(), 0, Kind::counter});
+    }
+
+    void write_chrome_json(std::ostream &os)
+    {
+        std::lock_guard<std::mutex> lock{mBuffersMutex};
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (auto &buffer : mBuffers)
+            for (Chunk *c = buffer->head; c; c = c->next.load(std::memory_order_acquire))
+            {
+                std::size_t n = c->count.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    os << (first ? "\n" : ",\n");
+                    write_event(os, buffer->tid, c->events[i]);
+                    first = false;
+                }
+            }
+        os << "\n]}\n";
+    }
+
+    bool write_chrome_json(const char *path)
+    {
+        std::ofstream file{path};
+        write_chrome_json(file);
+        return bool(file);
+    }
+};
+
+// Zakres RAII: jedno zdarzenie "X" (początek + czas trwania) przy wyjściu
+class Trace_span
+{
+private:
+    const char *mName;
+    const char *mArgName;
+    std::int64_t mArg;
+    std::uint64_t mStart;
+
+public:
+    explicit Trace_span(const char *name, const char *argName = nullptr, std::int64_t arg = 0)
+        : mName(name), mArgName(argName), mArg(arg), mStart(Tracer::global().now_ns()) {}
+
+    Trace_span(const Trace_span &) = delete;
+    Trace_span &operator=(const Trace_span &) = delete;
+
+    ~Trace_span()
+    {
+        Tracer &tracer = Tracer::global();
+        tracer.record({mName, mArgName, mArg, mStart, tracer.now_ns() - mStart, Tracer::Kind::span});
+    }
+};
+
+#define CPPLAB_TRACE_CONCAT2(a, b) a##b
+#define CPPLAB_TRACE_CONCAT(a, b) CPPLAB_TRACE_CONCAT2(a, b)
+
+#define TRACE_SPAN(name) Trace_span CPPLAB_TRACE_CONCAT(traceSpan, __LINE__){name}
+#define TRACE_SPAN_ARG(name, argName, value) \
+    Trace_span CPPLAB_TRACE_CONCAT(traceSpan, __LINE__){name, argName, std::int64_t(value)}
+#define TRACE_INSTANT(name) Tracer::global().instant(name)
+#define TRACE_COUNTER(name, value) Tracer::global().counter(name, std::int64_t(value))
+#define TRACE_EXPORT(path) Tracer::global().write_chrome_json(path)
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_SPAN_ARG(name, argName, value) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#define TRACE_EXPORT(path) ((void)0)
+
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Przenaszalny (niekopiowalny) odpowiednik std::function.
+// Małe obiekty wywoływalne trzymane są w buforze wewnątrz obiektu (SBO),
+// więc lambdy z kilkoma przechwyconymi wartościami nie alokują pamięci.
+template <typename Signature, std::size_t BufferSize = 48>
+class Unique_function;
+
+template <typename R, typename... Args, std::size_t BufferSize>
+class Unique_function<R(Args...), BufferSize>
+{
+private:
+    struct VTable
+    {
+        R (*invoke)(void *storage, Args &&...args);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr bool fitsInline = sizeof(F) <= BufferSize &&
+                                       alignof(F) <= alignof(std::max_align_t) &&
+                                       std::is_nothrow_move_constructible_v<F>;
+
+    // obiekt zapisany bezpośrednio w buforze
+    template <typename F>
+    static constexpr VTable inlineVTable{
+        [](void *storage, Args &&...args) -> R
+        { return (*static_cast<F *>(storage))(std::forward<Args>(args)...); },
+        [](void *dst, void *src) noexcept
+        {
+            ::new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        },
+        [](void *storage) noexcept
+        { static_cast<F *>(storage)->~F(); }};
+
+    // obiekt na stercie, w buforze tylko wskaźnik
+    template <typename F>
+    static constexpr VTable heapVTable{
+        [](void *storage, Args &&...args) -> R
+        { return (**static_cast<F **>(storage))(std::forward<Args>(args)...); },
+        [](void *dst, void *src) noexcept
+        {
+            ::new (dst) F *(*static_cast<F **>(src));
+        },
+        [](void *storage) noexcept
+        { delete *static_cast<F **>(storage); }};
+
+    alignas(std::max_align_t) unsigned char storage[BufferSize];
+    const VTable *vtable{nullptr};
+
+public:
+    Unique_function() noexcept = default;
+    Unique_function(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<D, Unique_function> &&
+                                          std::is_invocable_r_v<R, D &, Args...>>>
+    Unique_function(F &&f)
+    {
+        if constexpr (fitsInline<D>)
+        {
+            ::new (static_cast<void *>(storage)) D(std::forward<F>(f));
+            vtable = &inlineVTable<D>;
+        }
+        else
+        {
+            ::new (static_cast<void *>(storage)) D *(new D(std::forward<F>(f)));
+            vtable = &heapVTable<D>;
+        }
+    }
+
+    Unique_function(Unique_function &&other) noexcept : vtable(other.vtable)
+    {
+        if (vtable)
+        {
+            vtable->move(storage, other.storage);
+            other.vtable = nullptr;
+        }
+    }
+
+    Unique_function &operator=(Unique_function &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.vtable)
+            {
+                other.vtable->move(storage, other.storage);
+                vtable = other.vtable;
+                other.vtable = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Unique_function(const Unique_function &) = delete;
+    Unique_function &operator=(const Unique_function &) = delete;
+
+    ~Unique_function()
+    {
+        reset();
+    }
+
+    R operator()(Args... args)
+    {
+        return vtable->invoke(storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return vtable != nullptr;
+    }
+
+    void reset() noexcept
+    {
+        if (vtable)
+        {
+            vtable->destroy(storage);
+            vtable = nullptr;
+        }
+    }
+};
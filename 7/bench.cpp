@@ -0,0 +1,386 @@
+#include <iostream>
+#include <barrier>
+#include <random>
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "my_class.h"
+#include "fleet_simulation.h"
+#include "cpplab.h"
+#include "slab_pool.h"
+#include "../6/thread_pool.cpp"
+
+// Dawny fuel_tank: mutex na każde pobranie (bez printf, który i tak
+// zdominowałby pomiar)
+class locked_tank
+{
+private:
+    unsigned int fuel;
+    std::mutex mutex;
+
+public:
+    locked_tank(unsigned int n) : fuel{n} {};
+
+    unsigned int refuel(unsigned int n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fuel >= n)
+        {
+            fuel -= n;
+            return n;
+        }
+        return 0u;
+    }
+};
+
+// Mln pobrań na sekundę, gdy `engines` wątków pobiera z jednej puli zbiorników
+template <typename Draw>
+double mdraws_per_s(int engines, int draws, Draw draw)
+{
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int e = 0; e < engines; ++e)
+        threads.emplace_back([&] {
+            for (int i = 0; i < draws; ++i)
+                draw();
+        });
+    for (auto &t : threads)
+        t.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return engines * double(draws) / s / 1e6;
+}
+
+// Model wątek-na-silnik: każdy silnik to wątek, takty synchronizuje bariera
+static double thread_per_engine_ticks_per_s(int engines, int tanksPerEngine, int ticks)
+{
+    std::vector<std::shared_ptr<fuel_tank>> shared;
+    for (int i = 0; i < engines / 3 + 1; ++i)
+        shared.push_back(std::make_shared<fuel_tank>(1000000u));
+
+    std::barrier sync(engines);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int e = 0; e < engines; ++e)
+        threads.emplace_back([&, e] {
+            std::vector<std::shared_ptr<fuel_tank>> tanks;
+            for (int k = 0; k < tanksPerEngine; ++k)
+                tanks.push_back(shared[(e / 3 + k) % shared.size()]);
+            for (int t = 0; t < ticks; ++t)
+            {
+                if (!tanks.empty() && 0u == tanks.back()->refuel(1 + e % 3))
+                    tanks.pop_back();
+                sync.arrive_and_wait();
+            }
+        });
+    for (auto &t : threads)
+        t.join();
+    return ticks / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double soa_ticks_per_s(int engines, int tanksPerEngine, int ticks, Thread_pool &pool, std::size_t parts)
+{
+    fleet_simulation sim;
+    int numTanks = engines / 3 + 1;
+    for (int i = 0; i < numTanks; ++i)
+        sim.addTank(1000000u);
+    for (int e = 0; e < engines; ++e)
+    {
+        auto id = sim.addEngine(1, 1 + e % 3);
+        for (int k = 0; k < tanksPerEngine; ++k)
+            sim.connectFuelTank(id, std::uint32_t((e / 3 + k) % numTanks));
+    }
+
+    sim.step(pool, parts);
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t)
+        sim.step(pool, parts);
+    return ticks / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void fleet_bench()
+{
+    Thread_pool pool{4};
+    std::cout << "\nengines  model              ticks/s     engine-ticks/s\n";
+    for (int engines : {100, 1000})
+    {
+        double tps = thread_per_engine_ticks_per_s(engines, 5, 200);
+        std::cout << engines << "\t thread-per-engine  " << tps << "\t" << tps * engines << '\n';
+    }
+    for (int engines : {1000, 100000, 400000})
+        for (std::size_t parts : {1, 4})
+        {
+            double tps = soa_ticks_per_s(engines, 5, 50, pool, parts);
+            std::cout << engines << "\t SoA, " << parts << " part(s)     " << tps << "\t" << tps * engines << '\n';
+        }
+}
+
+// Deleter ze stanem (np. arena) zajmuje miejsce, bezstanowy - nie
+struct counting_delete
+{
+    long *count;
+    void operator()(int *p) const { ++*count; delete p; }
+};
+static_assert(sizeof(cpplab::unique_ptr<int>) == sizeof(int *));
+static_assert(sizeof(cpplab::unique_ptr<int, counting_delete>) == 2 * sizeof(int *));
+
+// Własność przechodzi przez granicę, której kompilator nie widzi: obiekt
+// tworzy jedna funkcja noipa, niszczy druga, więc new/delete nie mogą
+// zostać pominięte (w jednej funkcji -O2 usuwa całą parę i mierzy pustą
+// pętlę). Różnice kodu pokazuje 7/pointer_asm.sh: unique_ptr ma nietrywialny
+// destruktor, więc ABI przekazuje go przez pamięć, nie w rejestrze.
+__attribute__((noinline, noipa)) int *raw_make(int i)
+{
+    return new int(i);
+}
+
+__attribute__((noinline, noipa)) long raw_take(int *p) noexcept
+{
+    long v = *p;
+    delete p;
+    return v;
+}
+
+__attribute__((noinline, noipa)) cpplab::unique_ptr<int> cpplab_make(int i)
+{
+    return cpplab::make_unique<int>(i);
+}
+
+// parametr przez wartość niszczy wołający (Itanium ABI)
+__attribute__((noinline, noipa)) long cpplab_take(cpplab::unique_ptr<int> p) noexcept
+{
+    return *p;
+}
+
+__attribute__((noinline, noipa)) std::unique_ptr<int> std_make(int i)
+{
+    return std::make_unique<int>(i);
+}
+
+__attribute__((noinline, noipa)) long std_take(std::unique_ptr<int> p) noexcept
+{
+    return *p;
+}
+
+__attribute__((noinline, noipa)) long raw_round_trip(int i)
+{
+    return raw_take(raw_make(i));
+}
+
+__attribute__((noinline, noipa)) long cpplab_round_trip(int i)
+{
+    return cpplab_take(cpplab_make(i));
+}
+
+__attribute__((noinline, noipa)) long std_round_trip(int i)
+{
+    return std_take(std_make(i));
+}
+
+__attribute__((noinline)) long cpplab_array(int n)
+{
+    auto a = cpplab::make_unique_for_overwrite<int[]>(n);
+    for (int i = 0; i < n; ++i)
+        a[i] = i;
+    return a[n - 1];
+}
+
+template <typename F>
+static double ns_per_iter(int iters, F f)
+{
+    volatile long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i)
+        sink = sink + f(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iters;
+}
+
+static void pointer_bench()
+{
+    const int iters = 5000000;
+    std::cout << "\nnew -> return ownership -> pass ownership -> delete, through noipa calls (malloc included;\n"
+              << "unique_ptr travels through memory per the ABI, code compared by 7/pointer_asm.sh):\n"
+              << "  raw int* " << ns_per_iter(iters, raw_round_trip)
+              << " ns, cpplab::unique_ptr " << ns_per_iter(iters, cpplab_round_trip)
+              << " ns, std::unique_ptr " << ns_per_iter(iters, std_round_trip) << " ns\n"
+              << "unique_ptr<int[]>(64) for_overwrite: " << ns_per_iter(iters / 10, [](int) { return cpplab_array(64); }) << " ns\n";
+}
+
+struct counted_tank : cpplab::intrusive_ref_counter<counted_tank>
+{
+    unsigned int fuel{0};
+};
+
+// Mln kopii + zniszczeń na sekundę; wszystkie wątki kopiują ten sam wskaźnik,
+// więc liczniki referencji są wspólną, gorącą linią pamięci
+template <typename Ptr>
+static double mcopies_per_s(int threads, int copies, const Ptr &shared)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&] {
+            for (int i = 0; i < copies; ++i)
+            {
+                Ptr copy = shared;
+                asm volatile("" : : "r"(copy.get()) : "memory");
+            }
+        });
+    for (auto &w : workers)
+        w.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * double(copies) / s / 1e6;
+}
+
+static void shared_bench()
+{
+    const int copies = 2000000;
+    auto stdPtr = std::make_shared<fuel_tank>(0u);
+    auto labPtr = cpplab::make_shared<fuel_tank>(0u);
+    auto intrusive = cpplab::make_intrusive<counted_tank>();
+
+    std::cout << "\nthreads  std::shared_ptr  cpplab::shared_ptr  intrusive_ptr  [Mcopies/s]\n";
+    for (int threads : {1, 2, 4, 8})
+        std::cout << threads << "\t " << mcopies_per_s(threads, copies, stdPtr)
+                  << "\t\t  " << mcopies_per_s(threads, copies, labPtr)
+                  << "\t      " << mcopies_per_s(threads, copies, intrusive) << '\n';
+
+    // licznik nieatomowy - tylko jeden wątek
+    auto local = cpplab::make_local_shared<fuel_tank>(0u);
+    std::cout << "1\t local_shared_ptr " << mcopies_per_s(1, copies, local) << '\n';
+}
+
+// Mln par alokacja + zwolnienie na sekundę; każdy wątek trzyma naraz
+// `live` obiektów i wymienia je w kółko
+template <typename Make>
+static double mallocs_per_s(int threads, int rounds, std::size_t live, Make make)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&] {
+            std::vector<decltype(make(0u))> held(live);
+            for (int r = 0; r < rounds; ++r)
+                for (std::size_t i = 0; i < live; ++i)
+                    held[i] = make(unsigned(i));
+        });
+    for (auto &w : workers)
+        w.join();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * double(rounds) * live / s / 1e6;
+}
+
+#ifdef __linux__
+static double rss_mb()
+{
+    long pages = 0, resident = 0;
+    if (FILE *f = std::fopen("/proc/self/statm", "r"))
+    {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(f);
+    }
+    return resident * double(sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// RSS: po zaalokowaniu n zbiorników, po zwolnieniu losowych 90%, po
+// ponownym zaalokowaniu tej samej liczby. Każdy wariant w osobnym procesie,
+// żeby nie dziedziczył sterty poprzedniego.
+template <typename Ptr, typename Make>
+static void rss_run(const char *name, std::size_t n, Make make)
+{
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        waitpid(pid, nullptr, 0);
+        return;
+    }
+
+    // pomocnicze tablice przed pomiarem, żeby liczyć tylko same obiekty
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+    std::vector<Ptr> tanks(n), again(n / 10 * 9);
+
+    double base = rss_mb();
+    for (std::size_t i = 0; i < n; ++i)
+        tanks[i] = make(unsigned(i));
+    double full = rss_mb() - base;
+
+    for (std::size_t i = 0; i < n / 10 * 9; ++i)
+        tanks[order[i]] = Ptr();
+    double sparse = rss_mb() - base;
+
+    for (std::size_t i = 0; i < n / 10 * 9; ++i)
+        again[i] = make(unsigned(i));
+    double refilled = rss_mb() - base;
+
+    std::cout << name << "\t " << full << "\t  " << sparse << "\t      " << refilled << '\n';
+    std::cout.flush();
+    _exit(0);
+}
+#endif
+
+static void slab_bench()
+{
+    auto heap = [](unsigned n) { return std::unique_ptr<fuel_tank>(new fuel_tank(n)); };
+    auto pooled = [](unsigned n) { return cpplab::make_pooled<fuel_tank>(n); };
+
+    std::cout << "\nthreads  live    new/delete  slab_pool  [Mallocs/s]\n";
+    for (int threads : {1, 2, 4})
+        for (std::size_t live : {1, 1000, 100000})
+        {
+            int rounds = int(4000000 / live);
+            std::cout << threads << "\t " << live << "\t " << mallocs_per_s(threads, rounds, live, heap)
+                      << "\t     " << mallocs_per_s(threads, rounds, live, pooled) << '\n';
+        }
+}
+
+// Przed pozostałymi testami, póki sterta (dziedziczona przez fork) jest pusta
+static void rss_bench()
+{
+#ifdef __linux__
+    const std::size_t n = 4000000;
+    std::cout << "RSS [MB], " << n << " x fuel_tank   full   90% freed   refilled\n";
+    rss_run<std::unique_ptr<fuel_tank>>("new/delete", n, [](unsigned i) { return std::unique_ptr<fuel_tank>(new fuel_tank(i)); });
+    rss_run<cpplab::pooled_ptr<fuel_tank>>("slab_pool ", n, [](unsigned i) { return cpplab::make_pooled<fuel_tank>(i); });
+    std::cout << '\n';
+#endif
+}
+
+int main()
+{
+    rss_bench();
+
+    const int numTanks = 5, draws = 200000;
+    const unsigned int full = 4000000000u;
+
+    std::cout << "engines  mutex(back)  atomic(back)  draw_from_any  [Mdraws/s]\n";
+    for (int engines : {1, 3, 12, 48})
+    {
+        std::vector<std::unique_ptr<locked_tank>> locked;
+        std::vector<std::shared_ptr<fuel_tank>> tanks;
+        for (int i = 0; i < numTanks; ++i)
+        {
+            locked.push_back(std::make_unique<locked_tank>(full));
+            tanks.push_back(std::make_shared<fuel_tank>(full));
+        }
+
+        // jak dawny engine: wszyscy ciągną z ostatniego zbiornika
+        double a = mdraws_per_s(engines, draws, [&] { locked.back()->refuel(1); });
+        double b = mdraws_per_s(engines, draws, [&] { tanks.back()->try_draw(1); });
+        double c = mdraws_per_s(engines, draws, [&] { draw_from_any(tanks, 1); });
+
+        std::cout << engines << "\t " << a << "\t      " << b << "\t    " << c << '\n';
+    }
+
+    fleet_bench();
+
+    pointer_bench();
+
+    shared_bench();
+
+    slab_bench();
+}
@@ -1,39 +1,97 @@
+#pragma once
+
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <new>
 
 namespace cpplab
 {
 
+    // Domyślny deleter - bezstanowy, więc nie zajmuje miejsca w unique_ptr
+    template <typename T>
+    struct default_delete
+    {
+        constexpr default_delete() noexcept = default;
+
+        template <typename U>
+            requires std::convertible_to<U *, T *>
+        default_delete(const default_delete<U> &) noexcept {}
+
+        void operator()(T *p) const
+        {
+            static_assert(sizeof(T) > 0, "cannot delete an incomplete type");
+            delete p;
+        }
+    };
+
     template <typename T>
+    struct default_delete<T[]>
+    {
+        void operator()(T *p) const
+        {
+            static_assert(sizeof(T) > 0, "cannot delete an incomplete type");
+            delete[] p;
+        }
+    };
+
+    template <typename T, typename Deleter = default_delete<T>>
     class unique_ptr
     {
     private:
         T *ptr;
+        // pusty deleter nie zwiększa rozmiaru: sizeof(unique_ptr<T>) == sizeof(T *)
+        [[no_unique_address]] Deleter deleter;
+
+        template <typename U, typename E>
+        friend class unique_ptr;
 
     public:
+        using pointer = T *;
+        using element_type = T;
+        using deleter_type = Deleter;
+
         // Konstruktor
-        explicit unique_ptr(T *p = nullptr) : ptr(p) {}
+        explicit unique_ptr(T *p = nullptr) noexcept : ptr(p), deleter() {}
+
+        unique_ptr(T *p, const Deleter &d) noexcept : ptr(p), deleter(d) {}
+        unique_ptr(T *p, Deleter &&d) noexcept : ptr(p), deleter(std::move(d)) {}
 
         // Destruktor
         ~unique_ptr()
         {
-            delete ptr;
+            if (ptr)
+                deleter(ptr);
         }
 
+        unique_ptr(const unique_ptr &) = delete;
+        unique_ptr &operator=(const unique_ptr &) = delete;
+
         // Operator przypisania
-        unique_ptr &operator=(unique_ptr &&other)
+        unique_ptr &operator=(unique_ptr &&other) noexcept
         {
             if (this != &other)
             {
                 reset(other.release());
+                deleter = std::move(other.deleter);
             }
             return *this;
         }
 
         // Przenoszący konstruktor
-        unique_ptr(unique_ptr &&other) : ptr(other.release()) {}
+        unique_ptr(unique_ptr &&other) noexcept
+            : ptr(other.release()), deleter(std::move(other.deleter)) {}
+
+        // Przenoszący konstruktor z typu pochodnego
+        template <typename U, typename E>
+            requires std::convertible_to<U *, T *> && std::convertible_to<E, Deleter>
+        unique_ptr(unique_ptr<U, E> &&other) noexcept
+            : ptr(other.release()), deleter(std::move(other.deleter)) {}
 
         // Operator dereferencji
         T &operator*() const
@@ -42,13 +100,13 @@ namespace cpplab
         }
 
         // Operator dostępu do składowych
-        T *operator->() const
+        T *operator->() const noexcept
         {
             return ptr;
         }
 
         // Zwraca wskaźnik i uwalnia odpowiedzialność za niego
-        T *release()
+        T *release() noexcept
         {
             T *temp = ptr;
             ptr = nullptr;
@@ -56,35 +114,168 @@ namespace cpplab
         }
 
         // Resetuje wskaźnik na nowy obiekt
-        void reset(T *p = nullptr)
+        void reset(T *p = nullptr) noexcept
         {
             if (p != ptr)
             {
-                delete ptr;
+                T *old = ptr;
                 ptr = p;
+                if (old)
+                    deleter(old);
             }
         }
 
         // Zwraca wskaźnik
-        T *get() const
+        T *get() const noexcept
         {
             return ptr;
         }
+
+        Deleter &get_deleter() noexcept { return deleter; }
+        const Deleter &get_deleter() const noexcept { return deleter; }
+
+        explicit operator bool() const noexcept
+        {
+            return ptr != nullptr;
+        }
+
+        void swap(unique_ptr &other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            std::swap(deleter, other.deleter);
+        }
     };
 
+    // Wersja dla tablic: operator[] zamiast * i ->
+    template <typename T, typename Deleter>
+    class unique_ptr<T[], Deleter>
+    {
+    private:
+        T *ptr;
+        [[no_unique_address]] Deleter deleter;
+
+    public:
+        using pointer = T *;
+        using element_type = T;
+        using deleter_type = Deleter;
+
+        explicit unique_ptr(T *p = nullptr) noexcept : ptr(p), deleter() {}
+
+        unique_ptr(T *p, const Deleter &d) noexcept : ptr(p), deleter(d) {}
+        unique_ptr(T *p, Deleter &&d) noexcept : ptr(p), deleter(std::move(d)) {}
+
+        ~unique_ptr()
+        {
+            if (ptr)
+                deleter(ptr);
+        }
+
+        unique_ptr(const unique_ptr &) = delete;
+        unique_ptr &operator=(const unique_ptr &) = delete;
+
+        unique_ptr &operator=(unique_ptr &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset(other.release());
+                deleter = std::move(other.deleter);
+            }
+            return *this;
+        }
+
+        unique_ptr(unique_ptr &&other) noexcept
+            : ptr(other.release()), deleter(std::move(other.deleter)) {}
+
+        T &operator[](std::size_t i) const
+        {
+            return ptr[i];
+        }
+
+        T *release() noexcept
+        {
+            T *temp = ptr;
+            ptr = nullptr;
+            return temp;
+        }
+
+        void reset(T *p = nullptr) noexcept
+        {
+            if (p != ptr)
+            {
+                T *old = ptr;
+                ptr = p;
+                if (old)
+                    deleter(old);
+            }
+        }
+
+        T *get() const noexcept
+        {
+            return ptr;
+        }
+
+        Deleter &get_deleter() noexcept { return deleter; }
+        const Deleter &get_deleter() const noexcept { return deleter; }
+
+        explicit operator bool() const noexcept
+        {
+            return ptr != nullptr;
+        }
+
+        void swap(unique_ptr &other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            std::swap(deleter, other.deleter);
+        }
+    };
+
+    static_assert(sizeof(unique_ptr<int>) == sizeof(int *));
+    static_assert(sizeof(unique_ptr<int[]>) == sizeof(int *));
+
+    // make_unique: obiekt / tablica elementów zainicjowanych wartością
+    template <typename T, typename... Args>
+        requires(!std::is_array_v<T>)
+    unique_ptr<T> make_unique(Args &&...args)
+    {
+        return unique_ptr<T>(new T(std::forward<Args>(args)...));
+    }
+
+    template <typename T>
+        requires std::is_unbounded_array_v<T>
+    unique_ptr<T> make_unique(std::size_t n)
+    {
+        return unique_ptr<T>(new std::remove_extent_t<T>[n]());
+    }
+
+    // make_unique_for_overwrite: bez zerowania, np. dla buforów nadpisywanych w całości
+    template <typename T>
+        requires(!std::is_array_v<T>)
+    unique_ptr<T> make_unique_for_overwrite()
+    {
+        return unique_ptr<T>(new T);
+    }
+
+    template <typename T>
+        requires std::is_unbounded_array_v<T>
+    unique_ptr<T> make_unique_for_overwrite(std::size_t n)
+    {
+        return unique_ptr<T>(new std::remove_extent_t<T>[n]);
+    }
+
     template <typename T>
     concept NonNull = requires(T *t) {
         { t != nullptr } -> std::same_as<bool>;
     };
 
-    template <NonNull T>
+    template <NonNull T, typename Deleter = default_delete<T>>
     class non0_ptr
     {
     private:
         T *ptr;
+        [[no_unique_address]] Deleter deleter;
 
     public:
-        non0_ptr(T *p) : ptr(p)
+        non0_ptr(T *p, Deleter d = Deleter()) : ptr(p), deleter(std::move(d))
         {
             if (ptr == nullptr)
             {
@@ -92,14 +283,444 @@ namespace cpplab
             }
         }
 
+        // Przejmuje obiekt z unique_ptr (rzuca wyjątek, gdy ten jest pusty)
+        template <typename E>
+            requires std::convertible_to<E, Deleter>
+        non0_ptr(unique_ptr<T, E> &&p) : non0_ptr(p.get(), std::move(p.get_deleter()))
+        {
+            p.release();
+        }
+
+        // Kopia oznaczałaby podwójne zwolnienie, a przeniesienie zostawiłoby nullptr
+        non0_ptr(const non0_ptr &) = delete;
+        non0_ptr &operator=(const non0_ptr &) = delete;
+
         ~non0_ptr()
         {
-            delete ptr;
+            deleter(ptr);
+        }
+
+        T &operator*() const
+        {
+            return *ptr;
+        }
+
+        T *operator->() const noexcept
+        {
+            return ptr;
         }
 
         T *get() const
         {
             return ptr;
         }
+
+        Deleter &get_deleter() noexcept { return deleter; }
+    };
+
+    static_assert(sizeof(non0_ptr<int>) == sizeof(int *));
+
+    // Liczniki referencji: atomowe (współdzielenie między wątkami)
+    // i zwykłe (obiekt nie opuszcza wątku - bez kosztu operacji atomowych)
+    struct atomic_count
+    {
+        using type = std::atomic<long>;
+
+        static void increment(type &c) noexcept { c.fetch_add(1, std::memory_order_relaxed); }
+        static long decrement(type &c) noexcept { return c.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+        static long load(const type &c) noexcept { return c.load(std::memory_order_relaxed); }
+
+        static bool increment_if_nonzero(type &c) noexcept
+        {
+            long n = c.load(std::memory_order_relaxed);
+            while (n != 0)
+                if (c.compare_exchange_weak(n, n + 1, std::memory_order_relaxed))
+                    return true;
+            return false;
+        }
+    };
+
+    struct local_count
+    {
+        using type = long;
+
+        static void increment(type &c) noexcept { ++c; }
+        static long decrement(type &c) noexcept { return --c; }
+        static long load(const type &c) noexcept { return c; }
+
+        static bool increment_if_nonzero(type &c) noexcept
+        {
+            if (c == 0)
+                return false;
+            ++c;
+            return true;
+        }
+    };
+
+    // Blok kontrolny: uses - liczba shared_ptr, weaks - liczba weak_ptr
+    // plus jeden, dopóki żyje jakikolwiek shared_ptr
+    template <typename Count>
+    class control_block
+    {
+    private:
+        typename Count::type uses{1};
+        typename Count::type weaks{1};
+
+    protected:
+        // niszczy obiekt
+        virtual void dispose() noexcept = 0;
+        // zwalnia sam blok
+        virtual void destroy() noexcept = 0;
+        virtual ~control_block() = default;
+
+    public:
+        void add_ref() noexcept { Count::increment(uses); }
+        bool add_ref_if_alive() noexcept { return Count::increment_if_nonzero(uses); }
+        void add_weak_ref() noexcept { Count::increment(weaks); }
+        long use_count() const noexcept { return Count::load(uses); }
+
+        void release() noexcept
+        {
+            if (Count::decrement(uses) == 0)
+            {
+                dispose();
+                release_weak();
+            }
+        }
+
+        void release_weak() noexcept
+        {
+            if (Count::decrement(weaks) == 0)
+                destroy();
+        }
+    };
+
+    // Blok dla wskaźnika przekazanego z zewnątrz (osobna alokacja)
+    template <typename T, typename Deleter, typename Count>
+    class pointer_control_block final : public control_block<Count>
+    {
+    private:
+        T *ptr;
+        [[no_unique_address]] Deleter deleter;
+
+        // pusty wskaźnik nie trafia do deletera (np. pool_delete by go wyłuskał)
+        void dispose() noexcept override
+        {
+            if (ptr)
+                deleter(ptr);
+        }
+        void destroy() noexcept override { delete this; }
+
+    public:
+        pointer_control_block(T *p, Deleter d) : ptr(p), deleter(std::move(d)) {}
     };
-}
\ No newline at end of file
+
+    // Blok z obiektem w środku - make_shared robi jedną alokację
+    template <typename T, typename Count>
+    class inplace_control_block final : public control_block<Count>
+    {
+    private:
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        void dispose() noexcept override { get()->~T(); }
+        void destroy() noexcept override { delete this; }
+
+    public:
+        template <typename... Args>
+        explicit inplace_control_block(Args &&...args)
+        {
+            ::new (static_cast<void *>(storage)) T(std::forward<Args>(args)...);
+        }
+
+        T *get() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    template <typename T, typename Count>
+    class basic_weak_ptr;
+
+    template <typename T, typename Count>
+    class basic_shared_ptr
+    {
+    private:
+        T *ptr{nullptr};
+        control_block<Count> *block{nullptr};
+
+        template <typename U, typename C>
+        friend class basic_shared_ptr;
+        template <typename U, typename C>
+        friend class basic_weak_ptr;
+        template <typename U, typename C, typename... Args>
+        friend basic_shared_ptr<U, C> make_basic_shared(Args &&...args);
+
+        struct adopt_block
+        {
+        };
+
+        // przejmuje referencję już policzoną w bloku
+        basic_shared_ptr(adopt_block, T *p, control_block<Count> *b) noexcept : ptr(p), block(b) {}
+
+    public:
+        using element_type = T;
+
+        basic_shared_ptr() noexcept = default;
+        basic_shared_ptr(std::nullptr_t) noexcept {}
+
+        template <typename U, typename Deleter = default_delete<U>>
+            requires std::convertible_to<U *, T *>
+        explicit basic_shared_ptr(U *p, Deleter d = Deleter()) : ptr(p)
+        {
+            try
+            {
+                block = new pointer_control_block<U, Deleter, Count>(p, d);
+            }
+            catch (...)
+            {
+                d(p);
+                throw;
+            }
+        }
+
+        // Z pustego unique_ptr powstaje pusty wskaźnik bez bloku, jak w std
+        template <typename U, typename Deleter>
+            requires std::convertible_to<U *, T *>
+        basic_shared_ptr(unique_ptr<U, Deleter> &&p)
+        {
+            if (!p.get())
+                return;
+            block = new pointer_control_block<U, Deleter, Count>(p.get(), std::move(p.get_deleter()));
+            ptr = p.release();
+        }
+
+        basic_shared_ptr(const basic_shared_ptr &other) noexcept : ptr(other.ptr), block(other.block)
+        {
+            if (block)
+                block->add_ref();
+        }
+
+        basic_shared_ptr(basic_shared_ptr &&other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr)), block(std::exchange(other.block, nullptr)) {}
+
+        template <typename U>
+            requires std::convertible_to<U *, T *>
+        basic_shared_ptr(const basic_shared_ptr<U, Count> &other) noexcept : ptr(other.ptr), block(other.block)
+        {
+            if (block)
+                block->add_ref();
+        }
+
+        template <typename U>
+            requires std::convertible_to<U *, T *>
+        basic_shared_ptr(basic_shared_ptr<U, Count> &&other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr)), block(std::exchange(other.block, nullptr)) {}
+
+        ~basic_shared_ptr()
+        {
+            if (block)
+                block->release();
+        }
+
+        basic_shared_ptr &operator=(basic_shared_ptr other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        void swap(basic_shared_ptr &other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            std::swap(block, other.block);
+        }
+
+        void reset() noexcept
+        {
+            basic_shared_ptr().swap(*this);
+        }
+
+        T *get() const noexcept { return ptr; }
+        T &operator*() const { return *ptr; }
+        T *operator->() const noexcept { return ptr; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+
+        long use_count() const noexcept
+        {
+            return block ? block->use_count() : 0;
+        }
+    };
+
+    template <typename T, typename Count>
+    class basic_weak_ptr
+    {
+    private:
+        T *ptr{nullptr};
+        control_block<Count> *block{nullptr};
+
+    public:
+        basic_weak_ptr() noexcept = default;
+
+        template <typename U>
+            requires std::convertible_to<U *, T *>
+        basic_weak_ptr(const basic_shared_ptr<U, Count> &p) noexcept : ptr(p.ptr), block(p.block)
+        {
+            if (block)
+                block->add_weak_ref();
+        }
+
+        basic_weak_ptr(const basic_weak_ptr &other) noexcept : ptr(other.ptr), block(other.block)
+        {
+            if (block)
+                block->add_weak_ref();
+        }
+
+        basic_weak_ptr(basic_weak_ptr &&other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr)), block(std::exchange(other.block, nullptr)) {}
+
+        ~basic_weak_ptr()
+        {
+            if (block)
+                block->release_weak();
+        }
+
+        basic_weak_ptr &operator=(basic_weak_ptr other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            std::swap(block, other.block);
+            return *this;
+        }
+
+        long use_count() const noexcept
+        {
+            return block ? block->use_count() : 0;
+        }
+
+        bool expired() const noexcept
+        {
+            return use_count() == 0;
+        }
+
+        // Pusty wskaźnik, jeśli obiekt już nie istnieje
+        basic_shared_ptr<T, Count> lock() const noexcept
+        {
+            if (block && block->add_ref_if_alive())
+                return basic_shared_ptr<T, Count>(typename basic_shared_ptr<T, Count>::adopt_block{}, ptr, block);
+            return basic_shared_ptr<T, Count>();
+        }
+    };
+
+    template <typename T, typename Count, typename... Args>
+    basic_shared_ptr<T, Count> make_basic_shared(Args &&...args)
+    {
+        auto *block = new inplace_control_block<T, Count>(std::forward<Args>(args)...);
+        return basic_shared_ptr<T, Count>(typename basic_shared_ptr<T, Count>::adopt_block{}, block->get(), block);
+    }
+
+    template <typename T>
+    using shared_ptr = basic_shared_ptr<T, atomic_count>;
+    template <typename T>
+    using weak_ptr = basic_weak_ptr<T, atomic_count>;
+
+    // Tylko dla obiektów, które nie opuszczają jednego wątku
+    template <typename T>
+    using local_shared_ptr = basic_shared_ptr<T, local_count>;
+    template <typename T>
+    using local_weak_ptr = basic_weak_ptr<T, local_count>;
+
+    template <typename T, typename... Args>
+    shared_ptr<T> make_shared(Args &&...args)
+    {
+        return make_basic_shared<T, atomic_count>(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    local_shared_ptr<T> make_local_shared(Args &&...args)
+    {
+        return make_basic_shared<T, local_count>(std::forward<Args>(args)...);
+    }
+
+    static_assert(sizeof(shared_ptr<int>) == 2 * sizeof(void *));
+
+    // Licznik wbudowany w obiekt: klasa dziedziczy po intrusive_ref_counter<Klasa>
+    template <typename Derived, typename Count = atomic_count>
+    class intrusive_ref_counter
+    {
+    private:
+        mutable typename Count::type refs{0};
+
+    protected:
+        intrusive_ref_counter() = default;
+        intrusive_ref_counter(const intrusive_ref_counter &) noexcept {}
+        intrusive_ref_counter &operator=(const intrusive_ref_counter &) noexcept { return *this; }
+        ~intrusive_ref_counter() = default;
+
+    public:
+        friend void intrusive_ptr_add_ref(const Derived *p) noexcept
+        {
+            Count::increment(p->refs);
+        }
+
+        friend void intrusive_ptr_release(const Derived *p) noexcept
+        {
+            if (Count::decrement(p->refs) == 0)
+                delete p;
+        }
+
+        long use_count() const noexcept
+        {
+            return Count::load(refs);
+        }
+    };
+
+    // Wskaźnik bez bloku kontrolnego - licznik jest w obiekcie, a dostęp do
+    // niego przez intrusive_ptr_add_ref / intrusive_ptr_release (szukane przez ADL)
+    template <typename T>
+    class intrusive_ptr
+    {
+    private:
+        T *ptr{nullptr};
+
+    public:
+        intrusive_ptr() noexcept = default;
+
+        intrusive_ptr(T *p, bool addRef = true) : ptr(p)
+        {
+            if (ptr && addRef)
+                intrusive_ptr_add_ref(ptr);
+        }
+
+        intrusive_ptr(const intrusive_ptr &other) : intrusive_ptr(other.ptr) {}
+
+        intrusive_ptr(intrusive_ptr &&other) noexcept : ptr(std::exchange(other.ptr, nullptr)) {}
+
+        ~intrusive_ptr()
+        {
+            if (ptr)
+                intrusive_ptr_release(ptr);
+        }
+
+        intrusive_ptr &operator=(intrusive_ptr other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+            return *this;
+        }
+
+        void reset() noexcept
+        {
+            intrusive_ptr().swap(*this);
+        }
+
+        void swap(intrusive_ptr &other) noexcept
+        {
+            std::swap(ptr, other.ptr);
+        }
+
+        T *get() const noexcept { return ptr; }
+        T &operator*() const { return *ptr; }
+        T *operator->() const noexcept { return ptr; }
+        explicit operator bool() const noexcept { return ptr != nullptr; }
+    };
+
+    template <typename T, typename... Args>
+    intrusive_ptr<T> make_intrusive(Args &&...args)
+    {
+        return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+    }
+}
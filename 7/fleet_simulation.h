@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../6/thread_pool.h"
+
+// Wsadowa symulacja floty silników i zbiorników w układzie SoA (osobna
+// tablica na każde pole). Jeden krok symulacji to:
+//  1. przebieg po silnikach (podzielony między wątki) - odliczanie taktów
+//     i zbieranie żądań pobrania paliwa,
+//  2. pogrupowanie żądań według zbiornika (równoległe sortowanie przez
+//     zliczanie: histogramy kawałków, sumy prefiksowe, rozrzut; stabilne
+//     względem numeru silnika),
+//  3. rozstrzygnięcie żądań każdego zbiornika w kolejności numerów silników
+//     (zbiorniki podzielone między wątki),
+//  4. zastosowanie wyników do silników.
+// Wynik nie zależy od liczby wątków ani kolejności ich wykonania.
+class fleet_simulation
+{
+private:
+    struct request
+    {
+        std::uint32_t engine;
+        std::uint32_t tank;
+    };
+
+    // zbiorniki
+    std::vector<unsigned int> tankFuel;
+
+    // silniki
+    std::vector<unsigned int> interval;
+    std::vector<unsigned int> countdown;
+    std::vector<unsigned int> fuelAmount;
+    std::vector<std::uint64_t> consumed;
+    // zbiorniki silnika w formacie CSR; używany jest ostatni podłączony,
+    // a po odmowie zbiornik zostaje odłączony i silnik przechodzi do
+    // poprzedniego. [tankBegin, tankEnd) to zbiorniki wciąż podłączone.
+    std::vector<std::uint32_t> tankBegin;
+    std::vector<std::uint32_t> tankEnd;
+    std::vector<std::uint32_t> tankList;
+    std::vector<unsigned char> granted;
+
+    // połączenia dodane od ostatniej przebudowy CSR
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> connections;
+    bool dirty{false};
+
+    std::vector<std::vector<request>> partRequests;
+    // partOffset[p][t]: najpierw liczba żądań kawałka p do zbiornika t,
+    // po sumach prefiksowych - miejsce w byTank na pierwsze z nich
+    std::vector<std::vector<std::uint32_t>> partOffset;
+    std::vector<std::uint32_t> rangeBase;
+    std::vector<request> byTank;
+    std::vector<std::uint32_t> tankStart;
+
+    // Zbiorniki wciąż podłączone zostają (w tej samej kolejności), nowe
+    // połączenia trafiają za nie; odłączone po odmowie nie wracają
+    void build()
+    {
+        const std::size_t built = tankBegin.size();
+        std::vector<std::uint32_t> count(interval.size() + 1, 0);
+        for (std::size_t e = 0; e < built; ++e)
+            count[e + 1] = tankEnd[e] - tankBegin[e];
+        for (auto &c : connections)
+            count[c.first + 1]++;
+        for (std::size_t e = 0; e < interval.size(); ++e)
+            count[e + 1] += count[e];
+
+        std::vector<std::uint32_t> list(count.back(), 0);
+        std::vector<std::uint32_t> fill(count.begin(), count.end() - 1);
+        for (std::size_t e = 0; e < built; ++e)
+            for (std::uint32_t i = tankBegin[e]; i < tankEnd[e]; ++i)
+                list[fill[e]++] = tankList[i];
+        for (auto &c : connections)
+            list[fill[c.first]++] = c.second;
+
+        tankList.swap(list);
+        tankBegin.assign(count.begin(), count.end() - 1);
+        tankEnd = fill;
+        connections.clear();
+        dirty = false;
+    }
+
+    // Dzieli [0, n) na `parts` kawałków i wykonuje f(begin, end) na puli
+    template <typename F>
+    static void parallel_for(Thread_pool &pool, std::size_t parts, std::size_t n, F f)
+    {
+        std::vector<Task_future<void>> futures;
+        for (std::size_t p = 0; p < parts; ++p)
+        {
+            std::size_t begin = n * p / parts, end = n * (p + 1) / parts;
+            futures.push_back(pool.submit([&f, p, begin, end] { f(p, begin, end); }));
+        }
+        for (auto &fut : futures)
+            fut.get();
+    }
+
+public:
+    std::uint32_t addTank(unsigned int fuel)
+    {
+        tankFuel.push_back(fuel);
+        return std::uint32_t(tankFuel.size() - 1);
+    }
+
+    // interval - co ile taktów silnik pobiera n paliwa
+    std::uint32_t addEngine(unsigned int ticks, unsigned int n)
+    {
+        interval.push_back(std::max(1u, ticks));
+        countdown.push_back(std::max(1u, ticks));
+        fuelAmount.push_back(n);
+        consumed.push_back(0);
+        granted.push_back(0);
+        dirty = true;
+        return std::uint32_t(interval.size() - 1);
+    }
+
+    void connectFuelTank(std::uint32_t engine, std::uint32_t tank)
+    {
+        connections.emplace_back(engine, tank);
+        dirty = true;
+    }
+
+    unsigned int getfuel(std::uint32_t tank) const { return tankFuel[tank]; }
+    std::uint64_t getConsumed(std::uint32_t engine) const { return consumed[engine]; }
+    std::size_t engines() const { return interval.size(); }
+    std::size_t tanks() const { return tankFuel.size(); }
+
+    void step(Thread_pool &pool, std::size_t parts)
+    {
+        if (dirty)
+            build();
+        parts = std::max<std::size_t>(1, parts);
+        partRequests.resize(parts);
+        partOffset.resize(parts);
+
+        const std::size_t numEngines = interval.size();
+        const std::size_t numTanks = tankFuel.size();
+
+        // 1. odliczanie, żądania i histogram żądań kawałka według zbiornika
+        parallel_for(pool, parts, numEngines, [this, numTanks](std::size_t p, std::size_t begin, std::size_t end) {
+            unsigned int *cd = countdown.data();
+            const unsigned int *iv = interval.data();
+            for (std::size_t e = begin; e < end; ++e)
+                cd[e] -= 1;
+
+            auto &out = partRequests[p];
+            auto &count = partOffset[p];
+            out.clear();
+            count.assign(numTanks, 0);
+            for (std::size_t e = begin; e < end; ++e)
+            {
+                if (cd[e] == 0)
+                {
+                    cd[e] = iv[e];
+                    if (tankEnd[e] != tankBegin[e])
+                    {
+                        std::uint32_t t = tankList[tankEnd[e] - 1];
+                        out.push_back({std::uint32_t(e), t});
+                        count[t]++;
+                    }
+                }
+            }
+        });
+
+        // 2. sortowanie przez zliczanie według zbiornika. Kolejność w byTank:
+        // zbiornik, potem kawałek, potem silnik - ta sama co przy przeglądaniu
+        // kawałków po kolei, więc w obrębie zbiornika zostaje kolejność silników.
+        // 2a. suma żądań w każdym przedziale zbiorników
+        rangeBase.assign(parts + 1, 0);
+        parallel_for(pool, parts, numTanks, [this, parts](std::size_t q, std::size_t begin, std::size_t end) {
+            std::uint32_t sum = 0;
+            for (std::size_t p = 0; p < parts; ++p)
+                for (std::size_t t = begin; t < end; ++t)
+                    sum += partOffset[p][t];
+            rangeBase[q + 1] = sum;
+        });
+        for (std::size_t q = 0; q < parts; ++q)
+            rangeBase[q + 1] += rangeBase[q];
+
+        // 2b. sumy prefiksowe w przedziale, od jego początku w byTank
+        tankStart.resize(numTanks + 1);
+        tankStart[numTanks] = rangeBase[parts];
+        parallel_for(pool, parts, numTanks, [this, parts](std::size_t q, std::size_t begin, std::size_t end) {
+            std::uint32_t offset = rangeBase[q];
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                tankStart[t] = offset;
+                for (std::size_t p = 0; p < parts; ++p)
+                    offset += std::exchange(partOffset[p][t], offset);
+            }
+        });
+
+        // 2c. rozrzut - każdy kawałek pisze w swoje, rozłączne miejsca
+        byTank.resize(rangeBase[parts]);
+        parallel_for(pool, parts, parts, [this](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t p = begin; p < end; ++p)
+            {
+                auto &offset = partOffset[p];
+                for (auto &r : partRequests[p])
+                    byTank[offset[r.tank]++] = r;
+            }
+        });
+
+        // 3. rozstrzyganie - każdy zbiornik obsługuje dokładnie jeden wątek
+        parallel_for(pool, parts, numTanks, [this](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                unsigned int fuel = tankFuel[t];
+                for (std::uint32_t i = tankStart[t]; i < tankStart[t + 1]; ++i)
+                {
+                    std::uint32_t e = byTank[i].engine;
+                    bool ok = fuel >= fuelAmount[e];
+                    if (ok)
+                        fuel -= fuelAmount[e];
+                    granted[e] = ok;
+                }
+                tankFuel[t] = fuel;
+            }
+        });
+
+        // 4. wyniki - silnik pisze tylko swoje pola
+        parallel_for(pool, parts, parts, [this](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t p = begin; p < end; ++p)
+                for (auto &r : partRequests[p])
+                {
+                    if (granted[r.engine])
+                        consumed[r.engine] += fuelAmount[r.engine];
+                    else
+                        tankEnd[r.engine]--;
+                }
+        });
+    }
+};
@@ -1,6 +1,7 @@
 #include <iostream>
 #include "my_class.h"
 #include "cpplab.h"
+#include "../6/thread_pool.cpp"
 
 int main()
 {
@@ -21,6 +22,11 @@ int main()
         eng3.connectFuelTank(tank);
     }
 
+    // silniki tankują w tle, na wspólnym kole czasowym
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+    for (auto &tank : fuelTanks)
+        printf("Fuel: %u\n", tank->getfuel());
+
     cpplab::non0_ptr<int> myNonNullPtr(new int(42));
     std::cout << "Value using non0_ptr: " << *myNonNullPtr.get() << std::endl;
 
@@ -33,4 +39,6 @@ int main()
     {
         std::cerr << "Exception: " << e.what() << std::endl;
     }
+
+    TRACE_EXPORT("trace.json");
 }
\ No newline at end of file
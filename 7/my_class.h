@@ -3,12 +3,18 @@
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include <algorithm>
+#include <atomic>
+
+#include "../6/timer_wheel.h"
+#include "rcu.h"
+#include "../6/trace.h"
 
 class fuel_tank
 {
 private:
-    unsigned int fuel;
-    std::mutex mutex;
+    // Bez mutexu: każda zmiana to pojedyncza operacja atomowa (pętla CAS)
+    std::atomic<unsigned int> fuel;
 
 public:
     // inicjalizator
@@ -17,88 +23,135 @@ public:
     // destruktor
     ~fuel_tank(){};
     // konstruktor kopiujący
-    fuel_tank(const fuel_tank &other) { fuel = other.fuel; };
+    fuel_tank(const fuel_tank &other) : fuel{other.getfuel()} {};
 
     fuel_tank &operator=(const fuel_tank &other)
     {
-        fuel = other.fuel;
+        fuel.store(other.getfuel(), std::memory_order_relaxed);
         return *this;
     };
 
-    fuel_tank(fuel_tank &&other) noexcept { fuel = other.fuel; };
+    // konstruktor przenoszący - zabiera paliwo z drugiego zbiornika
+    fuel_tank(fuel_tank &&other) noexcept : fuel{other.fuel.exchange(0, std::memory_order_relaxed)} {};
 
     fuel_tank &operator=(fuel_tank &&other) noexcept
     {
-        fuel = other.fuel;
-        other.fuel = 0;
+        if (this != &other)
+            fuel.store(other.fuel.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
         return *this;
     };
 
-    unsigned int getfuel(){return fuel;}
+    unsigned int getfuel() const { return fuel.load(std::memory_order_relaxed); }
 
-    unsigned int refuel(unsigned int n)
+    // Pobiera dokładnie n albo nic
+    bool try_draw(unsigned int n)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        if (fuel >= n)
+        unsigned int current = fuel.load(std::memory_order_relaxed);
+        while (current >= n)
         {
-            fuel -= n;
-            printf("Fuel: %d\n", fuel);
-            return n;
+            if (fuel.compare_exchange_weak(current, current - n, std::memory_order_relaxed))
+                return true;
         }
-        else
+        return false;
+    }
+
+    // Pobiera ile się da, najwyżej n; zwraca pobraną ilość
+    unsigned int draw_up_to(unsigned int n)
+    {
+        unsigned int current = fuel.load(std::memory_order_relaxed);
+        while (current > 0)
         {
-            // unsigned int tmp = fuel;
-            // fuel = 0;
-            // return tmp;
-            return 0u;
+            unsigned int taken = std::min(current, n);
+            if (fuel.compare_exchange_weak(current, current - taken, std::memory_order_relaxed))
+                return taken;
         }
+        return 0u;
+    }
+
+    unsigned int refuel(unsigned int n)
+    {
+        return try_draw(n) ? n : 0u;
     };
 };
 
+// Pobiera n z najpełniejszego zbiornika. Gdy inny wątek nas wyprzedzi,
+// wybór jest powtarzany, bez żadnej globalnej blokady. Zwraca n albo 0.
+inline unsigned int draw_from_any(const std::vector<std::shared_ptr<fuel_tank>> &tanks, unsigned int n)
+{
+    for (std::size_t attempt = 0; attempt < tanks.size(); ++attempt)
+    {
+        fuel_tank *fullest = nullptr;
+        unsigned int best = 0;
+        for (auto &tank : tanks)
+        {
+            unsigned int level = tank->getfuel();
+            if (level >= n && level > best)
+            {
+                fullest = tank.get();
+                best = level;
+            }
+        }
+
+        if (!fullest)
+            return 0u;
+        if (fullest->try_draw(n))
+            return n;
+    }
+    return 0u;
+}
+
+// Wspólne koło czasowe dla wszystkich silników - takty tankowania
+// wykonuje pula o rozmiarze równym liczbie rdzeni
+inline Timer_wheel &engine_timers()
+{
+    static Thread_pool pool{std::max(1u, std::thread::hardware_concurrency())};
+    static Timer_wheel wheel{pool};
+    return wheel;
+}
+
 class engine
 {
 private:
-    std::vector<std::shared_ptr<fuel_tank>> tanks;
+    // takt tankowania czyta migawkę bez blokad; podłączanie publikuje nową wersję
+    cpplab::rcu_list<std::shared_ptr<fuel_tank>> tanks;
     std::chrono::seconds interval;
     unsigned int fuelAmount;
-    std::thread refuelThread;
-    std::mutex mutex;
+    Timer_wheel &timers;
+    Timer_wheel::Timer_id refuelTimer;
 
 public:
-    engine(std::chrono::seconds interval, unsigned int n)
-        : interval(interval), fuelAmount(n)
+    engine(std::chrono::seconds interval, unsigned int n, Timer_wheel &timers = engine_timers())
+        : interval(interval), fuelAmount(n), timers(timers)
     {
-        refuelThread = std::thread(&engine::refuelThreadFunc, this);
+        refuelTimer = timers.schedule_every(interval, [this] { refuelTick(); });
     };
     ~engine()
     {
-        if (refuelThread.joinable())
-        {
-            refuelThread.join();
-        }
+        timers.cancel(refuelTimer);
     };
 
 private:
-    void refuelThreadFunc();
+    void refuelTick();
 
 public:
     void connectFuelTank(std::shared_ptr<fuel_tank> tank)
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        tanks.push_back(tank);
+        tanks.push_back(std::move(tank));
+    }
+
+    void disconnectFuelTank(const std::shared_ptr<fuel_tank> &tank)
+    {
+        tanks.remove_if([&](const std::shared_ptr<fuel_tank> &t) { return t == tank; });
     }
 };
 
-void engine::refuelThreadFunc()
+// Puste zbiorniki zostają podłączone - draw_from_any je pomija, a takt
+// tankowania nigdy nie musi pisać do listy
+void engine::refuelTick()
 {
-    while (!tanks.empty())
-    {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto tank = tanks.back();
-        if (0u == tank->refuel(fuelAmount))
-        {
-            tanks.pop_back();
-        };
-        std::this_thread::sleep_for(std::chrono::seconds(interval));
-    } 
+    TRACE_SPAN("engine::refuelTick");
+    tanks.read([this](const std::vector<std::shared_ptr<fuel_tank>> &snapshot) {
+        if (draw_from_any(snapshot, fuelAmount) == 0u)
+            TRACE_INSTANT("engine out of fuel");
+    });
 };
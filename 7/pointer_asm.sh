@@ -0,0 +1,35 @@
+#!/bin/sh
+# Porównuje kod -O2 funkcji *_make, *_take i *_round_trip z bench.cpp:
+# cpplab::unique_ptr musi dać ten sam kod co std::unique_ptr (inaczej kod
+# wyjścia 1), a różnice względem surowego wskaźnika są tylko wypisywane.
+# Użycie: ./pointer_asm.sh  (kompilator z CXX, domyślnie g++)
+set -e
+cd "$(dirname "$0")"
+asm=$(mktemp)
+trap 'rm -f "$asm" "$asm".*' EXIT
+${CXX:-g++} -std=c++20 -O2 -pthread -S -fno-asynchronous-unwind-tables -o - bench.cpp | c++filt >"$asm"
+
+# treść funkcji bez dyrektyw, z ujednoliconymi etykietami i nazwami
+body()
+{
+    awk -v f="$1(" 'index($0, f) == 1 && /:$/ { on = 1; next } on && /^\t\.size/ { exit } on' "$asm" |
+        grep -v '^[[:space:]]*\.[a-z]' |
+        sed -E 's/\.L[A-Z]*[0-9]+/.L/g; s/(raw|cpplab|std)_/X_/g; s/(cpplab|std)::/P::/g'
+}
+
+status=0
+for f in make take round_trip; do
+    body "cpplab_$f" >"$asm.cpplab"
+    body "std_$f" >"$asm.std"
+    body "raw_$f" >"$asm.raw"
+    if diff -q "$asm.cpplab" "$asm.std" >/dev/null; then
+        echo "${f}: cpplab::unique_ptr == std::unique_ptr ($(wc -l <"$asm.cpplab") lines)"
+    else
+        echo "${f}: cpplab::unique_ptr != std::unique_ptr"
+        diff -u "$asm.std" "$asm.cpplab" || true
+        status=1
+    fi
+    echo "${f}: raw pointer vs unique_ptr"
+    diff -u "$asm.raw" "$asm.cpplab" || true
+done
+exit $status
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cpplab
+{
+
+    // Odzyskiwanie pamięci oparte na epokach (EBR). Czytelnik na czas odczytu
+    // ogłasza bieżącą epokę (epoch_guard); obiekt wycofany w epoce E jest
+    // zwalniany, gdy globalna epoka dojdzie do E + 2 - wtedy żaden czytelnik
+    // nie może już trzymać do niego wskaźnika.
+    class epoch_domain
+    {
+    private:
+        struct alignas(64) thread_record
+        {
+            // 0 - wątek poza sekcją odczytu
+            std::atomic<std::uint64_t> epoch{0};
+            std::atomic<bool> inUse{false};
+            unsigned int nesting{0};
+            thread_record *next{nullptr};
+        };
+
+        struct retired
+        {
+            void *ptr;
+            void (*deleter)(void *);
+            std::uint64_t epoch;
+        };
+
+        std::atomic<std::uint64_t> globalEpoch{1};
+        std::atomic<thread_record *> records{nullptr};
+        std::mutex retiredMutex;
+        std::vector<retired> retiredList;
+        // rozmiar retiredList, do sprawdzania bez blokady
+        std::atomic<std::size_t> pending{0};
+
+        epoch_domain() = default;
+
+        // Rekord wątku: przy pierwszym użyciu zajmujemy wolny albo dokładamy nowy;
+        // po zakończeniu wątku rekord wraca do ponownego użycia
+        thread_record &local()
+        {
+            struct holder
+            {
+                thread_record *record{nullptr};
+                ~holder()
+                {
+                    if (record)
+                        record->inUse.store(false, std::memory_order_release);
+                }
+            };
+            thread_local holder mine;
+
+            if (!mine.record)
+            {
+                for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+                {
+                    bool expected = false;
+                    if (!r->inUse.load(std::memory_order_relaxed) &&
+                        r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    {
+                        mine.record = r;
+                        break;
+                    }
+                }
+                if (!mine.record)
+                {
+                    thread_record *r = new thread_record;
+                    r->inUse.store(true, std::memory_order_relaxed);
+                    r->next = records.load(std::memory_order_relaxed);
+                    while (!records.compare_exchange_weak(r->next, r, std::memory_order_release))
+                        ;
+                    mine.record = r;
+                }
+            }
+            return *mine.record;
+        }
+
+        bool try_advance()
+        {
+            std::uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+            for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                std::uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+                if (e != 0 && e != epoch)
+                    return false;
+            }
+            return globalEpoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        }
+
+        // Wołane pod retiredMutex. Dwa przesunięcia epoki wystarczą, gdy
+        // żaden czytelnik nie jest w sekcji odczytu; inaczej resztę
+        // dokończy leave() ostatniego z nich.
+        void collect()
+        {
+            try_advance();
+            try_advance();
+            std::uint64_t safe = globalEpoch.load(std::memory_order_seq_cst);
+            std::size_t kept = 0;
+            for (auto &r : retiredList)
+            {
+                if (r.epoch + 2 <= safe)
+                    r.deleter(r.ptr);
+                else
+                    retiredList[kept++] = r;
+            }
+            retiredList.resize(kept);
+            pending.store(kept, std::memory_order_relaxed);
+        }
+
+    public:
+        // Nigdy nie niszczona: wątki kończące się po destruktorach obiektów
+        // statycznych (np. robotnicy puli z engine_timers) wciąż zwalniają
+        // swoje rekordy
+        static epoch_domain &global()
+        {
+            static epoch_domain *domain = new epoch_domain;
+            return *domain;
+        }
+
+        void enter()
+        {
+            thread_record &r = local();
+            if (r.nesting++ == 0)
+            {
+                r.epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        void leave()
+        {
+            thread_record &r = local();
+            if (--r.nesting == 0)
+            {
+                r.epoch.store(0, std::memory_order_release);
+                // coś czeka na zwolnienie - sprzątamy, o ile nie robi tego już inny wątek
+                if (pending.load(std::memory_order_relaxed) != 0 && retiredMutex.try_lock())
+                {
+                    collect();
+                    retiredMutex.unlock();
+                }
+            }
+        }
+
+        // Przekazuje obiekt do zwolnienia, gdy przestanie być widoczny dla czytelników
+        template <typename T>
+        void retire(T *p)
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            retiredList.push_back({p, [](void *q) { delete static_cast<T *>(q); },
+                                   globalEpoch.load(std::memory_order_seq_cst)});
+            collect();
+        }
+
+        // Próbuje od razu zwolnić wszystko, co już można
+        void reclaim()
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            collect();
+        }
+    };
+
+    // Sekcja odczytu (RAII)
+    class epoch_guard
+    {
+    public:
+        epoch_guard() { epoch_domain::global().enter(); }
+        ~epoch_guard() { epoch_domain::global().leave(); }
+
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard &operator=(const epoch_guard &) = delete;
+    };
+
+    // Lista do odczytu bez blokad. Czytelnicy przeglądają niezmienną migawkę,
+    // pisarze (serializowani między sobą) publikują nową wersję, a starą
+    // przekazują do epoch_domain.
+    template <typename T>
+    class rcu_list
+    {
+    private:
+        using snapshot = std::vector<T>;
+
+        std::atomic<const snapshot *> current;
+        std::mutex writers;
+
+        template <typename F>
+        void update(F f)
+        {
+            std::lock_guard<std::mutex> lock(writers);
+            const snapshot *old = current.load(std::memory_order_relaxed);
+            auto *next = new snapshot(*old);
+            f(*next);
+            current.store(next, std::memory_order_release);
+            epoch_domain::global().retire(const_cast<snapshot *>(old));
+        }
+
+    public:
+        rcu_list() : current(new snapshot()) {}
+
+        // Zakłada, że nikt już nie czyta
+        ~rcu_list()
+        {
+            delete current.load(std::memory_order_relaxed);
+        }
+
+        rcu_list(const rcu_list &) = delete;
+        rcu_list &operator=(const rcu_list &) = delete;
+
+        // Wywołuje f(const std::vector<T> &) na aktualnej migawce
+        template <typename F>
+        decltype(auto) read(F &&f) const
+        {
+            epoch_guard guard;
+            return std::forward<F>(f)(*current.load(std::memory_order_acquire));
+        }
+
+        void push_back(T value)
+        {
+            update([&](snapshot &s) { s.push_back(std::move(value)); });
+        }
+
+        template <typename P>
+        void remove_if(P pred)
+        {
+            update([&](snapshot &s) { std::erase_if(s, pred); });
+        }
+
+        void clear()
+        {
+            update([](snapshot &s) { s.clear(); });
+        }
+
+        std::size_t size() const
+        {
+            return read([](const snapshot &s) { return s.size(); });
+        }
+    };
+}
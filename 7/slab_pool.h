@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "cpplab.h"
+
+namespace cpplab
+{
+
+    // Alokator obiektów o stałym rozmiarze. Pamięć pochodzi z dużych bloków
+    // (slabów) dzielonych na równe sloty. Każdy wątek ma własną listę wolnych
+    // slotów, więc zwykłe allocate/deallocate nie biorą żadnej blokady; do
+    // wspólnego magazynu (depot) wątek sięga dopiero wtedy, gdy jego lista
+    // się opróżni albo urośnie, i zawsze przenosi całą paczkę slotów.
+    template <std::size_t Size, std::size_t Align>
+    class slab_pool
+    {
+    private:
+        struct node
+        {
+            node *next;
+        };
+
+        // paczka slotów połączonych przez next
+        struct chain
+        {
+            node *head{nullptr};
+            std::size_t count{0};
+        };
+
+        static constexpr std::size_t slotAlign = std::max(Align, alignof(node));
+        static constexpr std::size_t slotSize =
+            (std::max(Size, sizeof(node)) + slotAlign - 1) / slotAlign * slotAlign;
+        static constexpr std::size_t batchSize = 64;
+        static constexpr std::size_t slabBytes = std::max<std::size_t>(64 * 1024, slotSize * batchSize);
+
+        std::mutex depotMutex;
+        std::vector<chain> depot;
+        std::vector<void *> slabs;
+        // niepocięta jeszcze część ostatniego slabu
+        unsigned char *bump{nullptr};
+        unsigned char *bumpEnd{nullptr};
+
+        // Trywialnie niszczalna, więc dostępna do końca życia wątku; listę
+        // oddaje do magazynu osobny obiekt cache_reaper
+        struct thread_cache
+        {
+            chain local;
+            // po zniszczeniu obiektów thread_local wątku (np. w destruktorach
+            // obiektów statycznych) sloty idą prosto przez magazyn
+            bool dead{false};
+        };
+
+        struct cache_reaper
+        {
+            ~cache_reaper()
+            {
+                thread_cache &c = storage();
+                if (c.local.count)
+                    instance().give_back(c.local);
+                c.local = {};
+                c.dead = true;
+            }
+        };
+
+        slab_pool() = default;
+
+        static thread_cache &storage()
+        {
+            thread_local thread_cache mine;
+            return mine;
+        }
+
+        thread_cache &cache()
+        {
+            thread_local cache_reaper reaper;
+            (void)reaper;
+            return storage();
+        }
+
+        // Wołane pod depotMutex: tnie nową paczkę z bieżącego slabu
+        chain carve()
+        {
+            if (bump == bumpEnd)
+            {
+                auto *slab = static_cast<unsigned char *>(
+                    ::operator new(slabBytes, std::align_val_t(slotAlign)));
+                slabs.push_back(slab);
+                bump = slab;
+                bumpEnd = slab + slabBytes / slotSize * slotSize;
+            }
+            chain c;
+            while (c.count < batchSize && bump != bumpEnd)
+            {
+                auto *n = reinterpret_cast<node *>(bump);
+                n->next = c.head;
+                c.head = n;
+                c.count++;
+                bump += slotSize;
+            }
+            return c;
+        }
+
+        chain take()
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (depot.empty())
+                return carve();
+            chain c = depot.back();
+            depot.pop_back();
+            return c;
+        }
+
+        void give_back(chain c)
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            depot.push_back(c);
+        }
+
+        // Ścieżki bez listy wątku - tylko przy kończeniu wątku lub programu
+        void *allocate_shared()
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (depot.empty())
+                depot.push_back(carve());
+            chain &c = depot.back();
+            node *n = c.head;
+            c.head = n->next;
+            if (--c.count == 0)
+                depot.pop_back();
+            return n;
+        }
+
+        void deallocate_shared(node *n)
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            if (depot.empty() || depot.back().count >= batchSize)
+                depot.push_back({});
+            chain &c = depot.back();
+            n->next = c.head;
+            c.head = n;
+            c.count++;
+        }
+
+    public:
+        static constexpr std::size_t slot_size = slotSize;
+
+        // Nigdy nie niszczony: wątki mogą zwracać sloty jeszcze podczas
+        // kończenia programu, a pamięć i tak odda system
+        static slab_pool &instance()
+        {
+            static slab_pool *pool = new slab_pool;
+            return *pool;
+        }
+
+        slab_pool(const slab_pool &) = delete;
+        slab_pool &operator=(const slab_pool &) = delete;
+
+        void *allocate()
+        {
+            thread_cache &c = cache();
+            if (c.dead)
+                return allocate_shared();
+            chain &local = c.local;
+            if (!local.head)
+                local = take();
+            node *n = local.head;
+            local.head = n->next;
+            local.count--;
+            return n;
+        }
+
+        // Slot może zwolnić dowolny wątek - trafia wtedy do jego listy
+        void deallocate(void *p) noexcept
+        {
+            thread_cache &c = cache();
+            auto *n = static_cast<node *>(p);
+            if (c.dead)
+            {
+                deallocate_shared(n);
+                return;
+            }
+            chain &local = c.local;
+            n->next = local.head;
+            local.head = n;
+            // nadmiar (powyżej dwóch paczek) wraca do magazynu
+            if (++local.count == 2 * batchSize)
+            {
+                chain extra{local.head, batchSize};
+                node *last = local.head;
+                for (std::size_t i = 1; i < batchSize; ++i)
+                    last = last->next;
+                local.head = last->next;
+                last->next = nullptr;
+                local.count -= batchSize;
+                give_back(extra);
+            }
+        }
+
+        // Pamięć pobrana od systemu
+        std::size_t reserved_bytes()
+        {
+            std::lock_guard<std::mutex> lock(depotMutex);
+            return slabs.size() * slabBytes;
+        }
+    };
+
+    template <typename T>
+    slab_pool<sizeof(T), alignof(T)> &pool_for()
+    {
+        return slab_pool<sizeof(T), alignof(T)>::instance();
+    }
+
+    // Bezstanowy, więc unique_ptr<T, pool_delete<T>> ma rozmiar wskaźnika
+    template <typename T>
+    struct pool_delete
+    {
+        void operator()(T *p) const
+        {
+            p->~T();
+            pool_for<T>().deallocate(p);
+        }
+    };
+
+    template <typename T>
+    using pooled_ptr = unique_ptr<T, pool_delete<T>>;
+
+    template <typename T, typename... Args>
+        requires(!std::is_array_v<T>)
+    pooled_ptr<T> make_pooled(Args &&...args)
+    {
+        auto &pool = pool_for<T>();
+        void *p = pool.allocate();
+        try
+        {
+            return pooled_ptr<T>(::new (p) T(std::forward<Args>(args)...));
+        }
+        catch (...)
+        {
+            pool.deallocate(p);
+            throw;
+        }
+    }
+
+    static_assert(sizeof(pooled_ptr<int>) == sizeof(int *));
+}